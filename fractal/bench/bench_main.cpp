@@ -0,0 +1,31 @@
+#include <string>
+#include <thread>
+
+#include "benchmark/benchmark.h"
+#include "cpu_features.hpp"
+#include "float.hpp"
+
+// Results of two commits are compared from the JSON output:
+//   fractal_bench --benchmark_out=before.json --benchmark_out_format=json
+//   compare.py benchmarks before.json after.json  (tools/compare.py of google benchmark)
+// The context records the build settings and the CPU features the results depend on.
+int main(int argc, char** argv)
+{
+    benchmark::AddCustomContext("simd_isa", std::string(ToString(GetSimdIsa())));
+    benchmark::AddCustomContext("fma", HasFma() ? "yes" : "no");
+    benchmark::AddCustomContext("coordinate_type", std::string(kFloatName));
+    benchmark::AddCustomContext("float_backend", std::string(kFloatBackendName));
+    const bool expression_templates = kFloatExpressionTemplates == boost::multiprecision::et_on;
+    benchmark::AddCustomContext("float_expression_templates", expression_templates ? "on" : "off");
+    benchmark::AddCustomContext("hardware_threads", std::to_string(std::thread::hardware_concurrency()));
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    {
+        return 1;
+    }
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,74 @@
+#include <cstddef>
+
+#include "benchmark/benchmark.h"
+#include "double_double.hpp"
+#include "float.hpp"
+#include "fractal_settings.hpp"
+#include "precision.hpp"
+#include "quad_double.hpp"
+#include "real_traits.hpp"
+#include "vector.hpp"
+
+namespace
+{
+
+// Every task converts its start point and step from Float to the number type of its precision
+template <typename T>
+void BM_FloatCast(benchmark::State& state)
+{
+    const Float value = RealTraits<Float>::FromString("-0.743643887037158704752191506114774");
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(RealCast<T>(value));
+    }
+}
+
+// Start point of a task
+void BM_CoordAtPixel(benchmark::State& state)
+{
+    FractalSettings settings;
+    settings.SetViewportSize(1920, 1080);
+    settings.SetZoom(static_cast<uint16_t>(state.range(0)));
+    size_t pixel = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(settings.GetCoordAtPixel(pixel % 1920, pixel % 1080));
+        ++pixel;
+    }
+}
+
+// Precision is chosen for every frame and every tile level
+void BM_ChoosePrecision(benchmark::State& state)
+{
+    FractalSettings settings;
+    settings.SetViewportSize(1920, 1080);
+    settings.SetZoom(static_cast<uint16_t>(state.range(0)));
+    const Float& step = settings.GetStepPerPixel().x();
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(ChoosePrecision(step));
+    }
+}
+
+// Camera pan and zoom arithmetic on coordinates
+void BM_VectorMultiplyAdd(benchmark::State& state)
+{
+    Vector2f a;
+    a.Fill(RealTraits<Float>::FromString("-0.743643887037158704752191506114774"));
+    Vector2f b;
+    b.Fill(RealTraits<Float>::FromString("0.000000000000000001234567890123456789"));
+    for (auto _ : state)
+    {
+        Vector2f c = a;
+        c += b * Float(3.0);
+        benchmark::DoNotOptimize(c);
+    }
+}
+
+}  // namespace
+
+BENCHMARK(BM_FloatCast<DoubleDouble>);
+BENCHMARK(BM_FloatCast<QuadDouble>);
+BENCHMARK(BM_CoordAtPixel)->Arg(0)->Arg(4067);
+BENCHMARK(BM_ChoosePrecision)->Arg(0)->Arg(4067);
+BENCHMARK(BM_VectorMultiplyAdd);
@@ -0,0 +1,103 @@
+#include <cstddef>
+
+#include "benchmark/benchmark.h"
+#include "fixed_point.hpp"
+#include "float.hpp"
+
+namespace
+{
+
+// Inside the main cardioid: the orbit never escapes
+constexpr double kInsideX = -0.1;
+constexpr double kInsideY = 0.1;
+constexpr size_t kIterations = 1000;
+
+template <typename T>
+T MakeNumber(double value)
+{
+    if constexpr (requires { T::FromNumber(value); })
+    {
+        return T::FromNumber(value);
+    }
+    else
+    {
+        return T(value);
+    }
+}
+
+// Recurrence of MandelbrotLoop without interior checks which would skip the whole orbit
+template <typename T>
+T IterateOrbit(const T& x0, const T& y0, size_t iterations)
+{
+    T x2{0};
+    T y2{0};
+    T w{0};
+    for (size_t iteration = 0; iteration != iterations; ++iteration)
+    {
+        T x = x2 - y2 + x0;
+        T y = w - x2 - y2 + y0;
+        x2 = x * x;
+        y2 = y * y;
+        w = x + y;
+        w *= w;
+    }
+
+    return x2 + y2;
+}
+
+template <typename T>
+void BM_MandelbrotLoop(benchmark::State& state)
+{
+    const T x = MakeNumber<T>(kInsideX);
+    const T y = MakeNumber<T>(kInsideY);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(IterateOrbit<T>(x, y, kIterations));
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(kIterations));
+}
+
+template <typename T>
+void BM_Multiply(benchmark::State& state)
+{
+    T a = MakeNumber<T>(1.2345678901234567);
+    T b = MakeNumber<T>(-0.7654321098765432);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(a);
+        benchmark::DoNotOptimize(b);
+        T c = a * b;
+        benchmark::DoNotOptimize(c);
+    }
+}
+
+template <typename T>
+void BM_Square(benchmark::State& state)
+{
+    T a = MakeNumber<T>(1.2345678901234567);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(a);
+        T c = a * a;
+        benchmark::DoNotOptimize(c);
+    }
+}
+
+}  // namespace
+
+BENCHMARK(BM_MandelbrotLoop<Float>);
+BENCHMARK(BM_MandelbrotLoop<MultiFloat<100>>);
+BENCHMARK(BM_MandelbrotLoop<FixedPoint<2>>);
+BENCHMARK(BM_MandelbrotLoop<FixedPoint<4>>);
+BENCHMARK(BM_MandelbrotLoop<FixedPoint<6>>);
+BENCHMARK(BM_MandelbrotLoop<FixedPoint<16>>);
+
+BENCHMARK(BM_Multiply<Float>);
+BENCHMARK(BM_Multiply<MultiFloat<100>>);
+BENCHMARK(BM_Multiply<FixedPoint<2>>);
+BENCHMARK(BM_Multiply<FixedPoint<6>>);
+BENCHMARK(BM_Multiply<FixedPoint<16>>);
+
+BENCHMARK(BM_Square<MultiFloat<100>>);
+BENCHMARK(BM_Square<FixedPoint<6>>);
+BENCHMARK(BM_Square<FixedPoint<16>>);
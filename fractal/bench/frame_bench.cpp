@@ -0,0 +1,214 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "cpu_worker_pool.hpp"
+#include "fractal_settings.hpp"
+#include "frame_renderer.hpp"
+#include "palette.hpp"
+#include "real_traits.hpp"
+
+namespace
+{
+
+struct ReferenceLocation
+{
+    const char* center_x;
+    const char* center_y;
+    // Zoom steps of the app, the frame is about 4 * 0.95^zoom wide
+    uint16_t zoom;
+    uint32_t max_iterations;
+    size_t frame_size;
+};
+
+// Deep locations zoom into the Misiurewicz point i which is on the boundary at every scale
+constexpr ReferenceLocation kOverview{"-0.5", "0", 0, 1000, 256};
+constexpr ReferenceLocation kSeahorseValley{"-0.743643887037151", "0.131825904205330", 135, 2000, 256};
+constexpr ReferenceLocation kDeep1e20{"0", "1", 925, 1000, 128};
+constexpr ReferenceLocation kDeep1e50{"0", "1", 2271, 1000, 64};
+constexpr ReferenceLocation kDeep1e90{"0", "1", 4067, 1000, 32};
+
+FractalCPUWorkerPool& GetWorkers()
+{
+    static FractalCPUWorkerPool workers;
+    return workers;
+}
+
+FractalSettings MakeSettings(const ReferenceLocation& location, FractalRenderAlgorithm algorithm)
+{
+    FractalSettings settings;
+    settings.SetViewportSize(location.frame_size, location.frame_size);
+    settings.SetZoom(location.zoom);
+    Vector2f camera;
+    camera.x() = RealTraits<Float>::FromString(location.center_x);
+    camera.y() = RealTraits<Float>::FromString(location.center_y);
+    settings.SetCamera(camera);
+    settings.max_iterations = location.max_iterations;
+    settings.render_algorithm = algorithm;
+    settings.RandomizeColors();
+    return settings;
+}
+
+void RunFrames(benchmark::State& state, FractalCPUWorkerPool& workers, const FractalSettings& settings)
+{
+    MandelbrotStats stats;
+    RenderedFrame frame;
+    for (auto _ : state)
+    {
+        frame = RenderFrame(workers, settings);
+        stats += frame.stats;
+    }
+
+    const size_t pixels = settings.GetViewportWidth() * settings.GetViewportHeight();
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(pixels));
+    state.SetLabel(std::string(ToString(frame.precision)));
+    const auto frames = static_cast<double>(state.iterations());
+    state.counters["pixels_computed"] = static_cast<double>(stats.pixels_computed) / frames;
+    state.counters["pixels_filled"] = static_cast<double>(stats.pixels_filled) / frames;
+}
+
+// Full frame with all workers and automatic precision
+void BM_Frame(benchmark::State& state, const ReferenceLocation& location, FractalRenderAlgorithm algorithm)
+{
+    RunFrames(state, GetWorkers(), MakeSettings(location, algorithm));
+}
+
+void BM_FramePerturbation(benchmark::State& state, const ReferenceLocation& location)
+{
+    // Deltas are iterated in double so the frame is as large as the shallow ones
+    constexpr size_t kFrameSize = 256;
+    FractalSettings settings = MakeSettings(location, FractalRenderAlgorithm::BruteForce);
+    settings.SetViewportSize(kFrameSize, kFrameSize);
+    settings.use_perturbation = true;
+    RunFrames(state, GetWorkers(), settings);
+}
+
+// Seahorse valley frame on a pool of state.range(0) workers
+void BM_ThreadScaling(benchmark::State& state)
+{
+    FractalCPUWorkerPool workers(static_cast<size_t>(state.range(0)));
+    RunFrames(state, workers, MakeSettings(kSeahorseValley, FractalRenderAlgorithm::BruteForce));
+}
+
+void ThreadCounts(benchmark::internal::Benchmark* benchmark)
+{
+    const auto hardware_threads = static_cast<int64_t>(FractalCPUWorkerPool::GetDefaultThreadsCount());
+    for (int64_t threads = 1; threads < hardware_threads; threads *= 2)
+    {
+        benchmark->Arg(threads);
+    }
+    benchmark->Arg(hardware_threads);
+}
+
+std::vector<uint32_t> MakeIterations(size_t count, uint32_t max_iterations)
+{
+    std::mt19937 rnd(1234);
+    std::uniform_int_distribution<uint32_t> distribution(0, max_iterations);
+    std::vector<uint32_t> iterations(count);
+    std::ranges::generate(iterations, [&] { return distribution(rnd); });
+    return iterations;
+}
+
+PaletteLut MakePalette(uint32_t max_iterations)
+{
+    FractalSettings settings;
+    settings.RandomizeColors();
+    PaletteLut palette;
+    palette.Build(settings.colors, max_iterations);
+    return palette;
+}
+
+// Workers colorize every task they complete
+void BM_Colorize(benchmark::State& state)
+{
+    constexpr uint32_t kMaxIterations = 2000;
+    const PaletteLut palette = MakePalette(kMaxIterations);
+    const auto pixels = static_cast<size_t>(state.range(0));
+    const std::vector<uint32_t> iterations = MakeIterations(pixels, kMaxIterations);
+    std::vector<uint32_t> rgba(pixels);
+    for (auto _ : state)
+    {
+        palette.Colorize(iterations, rgba);
+        benchmark::DoNotOptimize(rgba.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * state.range(0) * 2 * static_cast<int64_t>(sizeof(uint32_t)));
+}
+
+// The CPU backend recolors a region of the retained 1920x1080 frame row by row before the texture
+// upload (palette changes, shifted frames, tiles). The OpenGL transfer itself is not included.
+void BM_UploadRegionColors(benchmark::State& state)
+{
+    constexpr size_t kFrameWidth = 1920;
+    constexpr size_t kFrameHeight = 1080;
+    constexpr uint32_t kMaxIterations = 2000;
+    const PaletteLut palette = MakePalette(kMaxIterations);
+    const std::vector<uint32_t> frame_iterations = MakeIterations(kFrameWidth * kFrameHeight, kMaxIterations);
+    const auto region_width = static_cast<size_t>(state.range(0));
+    const auto region_height = static_cast<size_t>(state.range(1));
+    std::vector<uint32_t> upload_pixels(region_width * region_height);
+    for (auto _ : state)
+    {
+        for (size_t y = 0; y != region_height; ++y)
+        {
+            palette.Colorize(
+                std::span{frame_iterations}.subspan(y * kFrameWidth, region_width),
+                std::span{upload_pixels}.subspan(y * region_width, region_width));
+        }
+        benchmark::DoNotOptimize(upload_pixels.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(1));
+}
+
+// Palette rebuild when max iterations change
+void BM_PaletteBuild(benchmark::State& state)
+{
+    FractalSettings settings;
+    settings.RandomizeColors();
+    const auto max_iterations = static_cast<uint32_t>(state.range(0));
+    for (auto _ : state)
+    {
+        PaletteLut palette;
+        palette.Build(settings.colors, max_iterations);
+        benchmark::DoNotOptimize(palette);
+    }
+}
+
+}  // namespace
+
+BENCHMARK_CAPTURE(BM_Frame, overview, kOverview, FractalRenderAlgorithm::BruteForce)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK_CAPTURE(BM_Frame, overview_solid_guessing, kOverview, FractalRenderAlgorithm::SolidGuessing)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK_CAPTURE(BM_Frame, seahorse_valley, kSeahorseValley, FractalRenderAlgorithm::BruteForce)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK_CAPTURE(BM_Frame, seahorse_valley_solid_guessing, kSeahorseValley, FractalRenderAlgorithm::SolidGuessing)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK_CAPTURE(BM_Frame, deep_1e20, kDeep1e20, FractalRenderAlgorithm::BruteForce)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK_CAPTURE(BM_Frame, deep_1e50, kDeep1e50, FractalRenderAlgorithm::BruteForce)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK_CAPTURE(BM_Frame, deep_1e90, kDeep1e90, FractalRenderAlgorithm::BruteForce)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK_CAPTURE(BM_FramePerturbation, deep_1e20, kDeep1e20)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK_CAPTURE(BM_FramePerturbation, deep_1e50, kDeep1e50)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK_CAPTURE(BM_FramePerturbation, deep_1e90, kDeep1e90)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+BENCHMARK(BM_ThreadScaling)->Apply(ThreadCounts)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+BENCHMARK(BM_Colorize)->Arg(128 * 128)->Arg(1920 * 1080);
+BENCHMARK(BM_UploadRegionColors)->Args({1920, 1080})->Args({192, 108})->Args({1920, 1});
+BENCHMARK(BM_PaletteBuild)->Arg(1000)->Arg(1'000'000);
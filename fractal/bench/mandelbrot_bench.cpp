@@ -0,0 +1,91 @@
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "double_double.hpp"
+#include "float.hpp"
+#include "mandelbrot.hpp"
+#include "mandelbrot_simd.hpp"
+#include "quad_double.hpp"
+#include "real_traits.hpp"
+
+namespace
+{
+
+// Escapes after about a thousand iterations: close to the neck between the cardioid and the period-2 bulb
+constexpr const char* kEdgeX = "-0.75";
+constexpr const char* kEdgeY = "0.003";
+constexpr size_t kMaxIterations = 100'000;
+
+// Row across the seahorse valley with a mix of fast, slow and interior pixels
+constexpr const char* kRowX = "-0.76";
+constexpr const char* kRowY = "0.1";
+constexpr const char* kRowStep = "0.00005";
+constexpr size_t kRowPixels = 1024;
+constexpr size_t kRowMaxIterations = 2000;
+
+template <typename T>
+T MakeNumber(const char* decimal)
+{
+    return RealCast<T>(RealTraits<Float>::Wide(decimal));
+}
+
+// Escape time loop used by the region evaluators for types without SIMD kernels
+template <typename T>
+void BM_EscapeTime(benchmark::State& state)
+{
+    const T x = MakeNumber<T>(kEdgeX);
+    const T y = MakeNumber<T>(kEdgeY);
+    size_t iterations = 0;
+    for (auto _ : state)
+    {
+        MandelbrotStats stats;
+        const size_t escape_time = MandelbrotLoop(x, y, kMaxIterations, stats);
+        benchmark::DoNotOptimize(escape_time);
+        iterations += escape_time - stats.cardioid_skipped - stats.periodicity_skipped;
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(iterations));
+}
+
+// Vectorized row kernel with lane refill
+template <typename T>
+void BM_EscapeTimeRow(benchmark::State& state)
+{
+    const T x = MakeNumber<T>(kRowX);
+    const T y = MakeNumber<T>(kRowY);
+    const T step = MakeNumber<T>(kRowStep);
+    std::vector<uint32_t> out(kRowPixels);
+    size_t iterations = 0;
+    for (auto _ : state)
+    {
+        MandelbrotStats stats;
+        MandelbrotRow(x, step, y, kRowMaxIterations, 0, out, stats);
+        benchmark::DoNotOptimize(out.data());
+        for (const uint32_t escape_time : out)
+        {
+            iterations += escape_time;
+        }
+
+        // Pixels proven to be inside by interior checks are not iterated
+        iterations -= stats.cardioid_skipped + stats.periodicity_skipped;
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(iterations));
+}
+
+}  // namespace
+
+BENCHMARK(BM_EscapeTime<float>);
+BENCHMARK(BM_EscapeTime<double>);
+BENCHMARK(BM_EscapeTime<DoubleDouble>);
+BENCHMARK(BM_EscapeTime<QuadDouble>);
+BENCHMARK(BM_EscapeTime<MultiFloat<50>>);
+BENCHMARK(BM_EscapeTime<MultiFloat<100>>);
+BENCHMARK(BM_EscapeTime<MultiFloat<1000>>);
+BENCHMARK(BM_EscapeTime<Float>);
+
+BENCHMARK(BM_EscapeTimeRow<float>);
+BENCHMARK(BM_EscapeTimeRow<double>);
+BENCHMARK(BM_EscapeTimeRow<DoubleDouble>);
+BENCHMARK(BM_EscapeTimeRow<QuadDouble>);
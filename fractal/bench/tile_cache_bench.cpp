@@ -0,0 +1,68 @@
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "tile_cache.hpp"
+
+namespace
+{
+
+constexpr size_t kTileBytes = TileCache::kTileSize * TileCache::kTileSize * sizeof(uint32_t);
+
+// Tiles of a 1920x1080 frame: 16x9 of them at one level
+constexpr int64_t kFrameTilesX = 16;
+constexpr int64_t kFrameTilesY = 9;
+
+TileKey MakeKey(int64_t x, int64_t y)
+{
+    TileKey key;
+    key.level = 10;
+    key.x = x;
+    key.y = y;
+    key.max_iterations = 1000;
+    return key;
+}
+
+// Composing a frame of cached tiles looks up every tile of the screen
+void BM_TileCacheFind(benchmark::State& state)
+{
+    TileCache cache(size_t{1} << 30);
+    for (int64_t y = 0; y != kFrameTilesY; ++y)
+    {
+        for (int64_t x = 0; x != kFrameTilesX; ++x)
+        {
+            cache.Insert(MakeKey(x, y), std::vector<uint32_t>(kTileBytes / sizeof(uint32_t)));
+        }
+    }
+
+    for (auto _ : state)
+    {
+        for (int64_t y = 0; y != kFrameTilesY; ++y)
+        {
+            for (int64_t x = 0; x != kFrameTilesX; ++x)
+            {
+                benchmark::DoNotOptimize(cache.Find(MakeKey(x, y)));
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * kFrameTilesX * kFrameTilesY);
+}
+
+// Completed tiles are inserted into a full cache which evicts the least recently used ones
+void BM_TileCacheInsertEvict(benchmark::State& state)
+{
+    TileCache cache(static_cast<size_t>(state.range(0)) * kTileBytes);
+    int64_t x = 0;
+    for (auto _ : state)
+    {
+        cache.Insert(MakeKey(x++, 0), std::vector<uint32_t>(kTileBytes / sizeof(uint32_t)));
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["evictions"] = static_cast<double>(cache.GetStats().evictions);
+}
+
+}  // namespace
+
+BENCHMARK(BM_TileCacheFind);
+BENCHMARK(BM_TileCacheInsertEvict)->Arg(64)->Arg(2048);
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "iteration_grid.hpp"
+#include "mandelbrot.hpp"
+
+// Boundary tracing of escape bands (the queue based variant by Joel Yliluoma).
+// Pixels on the region border are iterated first. A pixel whose neighbour has a different value
+// lies on a band contour, so its neighbours are traced too. When no contour pixels are left the
+// insides of closed contours are filled from the left neighbour in scan order.
+// Every region iterates its own border, so ThreadTask regions do not depend on each other.
+// Contours are traced in waves and every wave is iterated with one ComputePixels call to keep SIMD lanes busy.
+// The result is not exact: an island of a band that no traced contour reaches, like a lone escaping pixel
+// on a filament inside the set, is filled over. Test scenes differ from brute force in 0-3 pixels per 640k.
+// Evaluator::ComputePixels(std::span<const PixelIndex>) iterates the given pixels into the grid.
+template <typename Evaluator>
+class BoundaryTracingFill
+{
+public:
+    BoundaryTracingFill(IterationGrid grid, Evaluator& evaluator, MandelbrotStats& stats)
+        : grid_(grid),
+          evaluator_(evaluator),
+          stats_(stats)
+    {
+    }
+
+    void Run()
+    {
+        if (grid_.width == 0 || grid_.height == 0)
+        {
+            return;
+        }
+
+        flags_.assign(grid_.width * grid_.height, 0);
+        for (size_t x = 0; x != grid_.width; ++x)
+        {
+            Enqueue(x, 0);
+            Enqueue(x, grid_.height - 1);
+        }
+
+        for (size_t y = 1; y + 1 < grid_.height; ++y)
+        {
+            Enqueue(0, y);
+            Enqueue(grid_.width - 1, y);
+        }
+
+        while (!next_wave_.empty())
+        {
+            std::swap(wave_, next_wave_);
+            next_wave_.clear();
+
+            // Scan compares a pixel with its four neighbours so all of them are iterated first
+            batch_.clear();
+            for (const PixelIndex& pixel : wave_)
+            {
+                AddToBatch(pixel.x, pixel.y);
+            }
+
+            for (const PixelIndex& pixel : wave_)
+            {
+                if (pixel.x != 0) AddToBatch(pixel.x - 1, pixel.y);
+                if (pixel.x + 1 != grid_.width) AddToBatch(pixel.x + 1, pixel.y);
+                if (pixel.y != 0) AddToBatch(pixel.x, pixel.y - 1);
+                if (pixel.y + 1 != grid_.height) AddToBatch(pixel.x, pixel.y + 1);
+            }
+
+            if (!batch_.empty())
+            {
+                evaluator_.ComputePixels(batch_);
+            }
+
+            for (const PixelIndex& pixel : wave_)
+            {
+                Scan(pixel.x, pixel.y);
+            }
+        }
+
+        for (size_t y = 0; y != grid_.height; ++y)
+        {
+            for (size_t x = 1; x != grid_.width; ++x)
+            {
+                if (!(flags_[y * grid_.width + x] & kComputed))
+                {
+                    grid_.At(x, y) = grid_.At(x - 1, y);
+                    ++stats_.pixels_filled;
+                }
+            }
+        }
+    }
+
+private:
+    static constexpr uint8_t kComputed = 1;
+    static constexpr uint8_t kQueued = 2;
+
+    void Enqueue(size_t x, size_t y)
+    {
+        uint8_t& flags = flags_[y * grid_.width + x];
+        if (!(flags & kQueued))
+        {
+            flags |= kQueued;
+            next_wave_.push_back({x, y});
+        }
+    }
+
+    void AddToBatch(size_t x, size_t y)
+    {
+        uint8_t& flags = flags_[y * grid_.width + x];
+        if (!(flags & kComputed))
+        {
+            flags |= kComputed;
+            batch_.push_back({x, y});
+        }
+    }
+
+    // Neighbours with a different value are on the contour. Diagonal neighbours are traced too
+    // when the contour turns, otherwise it could leak between two diagonal pixels.
+    void Scan(size_t x, size_t y)
+    {
+        const uint32_t value = grid_.At(x, y);
+        const bool has_left = x != 0;
+        const bool has_right = x + 1 != grid_.width;
+        const bool has_up = y != 0;
+        const bool has_down = y + 1 != grid_.height;
+
+        const bool left = has_left && grid_.At(x - 1, y) != value;
+        const bool right = has_right && grid_.At(x + 1, y) != value;
+        const bool up = has_up && grid_.At(x, y - 1) != value;
+        const bool down = has_down && grid_.At(x, y + 1) != value;
+
+        if (left) Enqueue(x - 1, y);
+        if (right) Enqueue(x + 1, y);
+        if (up) Enqueue(x, y - 1);
+        if (down) Enqueue(x, y + 1);
+
+        if (has_up && has_left && (left || up)) Enqueue(x - 1, y - 1);
+        if (has_up && has_right && (right || up)) Enqueue(x + 1, y - 1);
+        if (has_down && has_left && (left || down)) Enqueue(x - 1, y + 1);
+        if (has_down && has_right && (right || down)) Enqueue(x + 1, y + 1);
+    }
+
+private:
+    IterationGrid grid_;
+    Evaluator& evaluator_;
+    MandelbrotStats& stats_;
+    std::vector<uint8_t> flags_;
+    std::vector<PixelIndex> wave_;
+    std::vector<PixelIndex> next_wave_;
+    std::vector<PixelIndex> batch_;
+};
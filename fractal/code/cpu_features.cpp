@@ -0,0 +1,52 @@
+#include "cpu_features.hpp"
+
+static SimdIsa DetectSimdIsa()
+{
+#if FRACTAL_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+    {
+        return SimdIsa::AVX512;
+    }
+
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return SimdIsa::AVX2;
+    }
+#endif
+
+    return SimdIsa::Scalar;
+}
+
+SimdIsa GetSimdIsa()
+{
+    static const SimdIsa isa = DetectSimdIsa();
+    return isa;
+}
+
+bool HasFma()
+{
+#if FRACTAL_X86_SIMD
+    static const bool has_fma = []
+    {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("fma") != 0;
+    }();
+    return has_fma;
+#else
+    return false;
+#endif
+}
+
+std::string_view ToString(SimdIsa isa)
+{
+    switch (isa)
+    {
+    case SimdIsa::AVX2:
+        return "AVX2";
+    case SimdIsa::AVX512:
+        return "AVX-512";
+    default:
+        return "Scalar";
+    }
+}
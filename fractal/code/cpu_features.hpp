@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define FRACTAL_X86_SIMD 1
+#else
+#define FRACTAL_X86_SIMD 0
+#endif
+
+enum class SimdIsa : uint8_t
+{
+    Scalar,
+    AVX2,
+    AVX512
+};
+
+// Best instruction set supported by both the CPU and the OS. Detected once.
+SimdIsa GetSimdIsa();
+
+// Fused multiply-add. Multi-precision kernels use it for exact products.
+bool HasFma();
+
+std::string_view ToString(SimdIsa isa);
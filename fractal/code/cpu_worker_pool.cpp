@@ -0,0 +1,597 @@
+#include "cpu_worker_pool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+#include "boundary_tracing.hpp"
+#include "interleaved_fill.hpp"
+#include "mariani_silver.hpp"
+#include "mandelbrot_simd.hpp"
+#include "perturbation.hpp"
+#include "real_traits.hpp"
+
+// Number types with row, column and scattered pixel kernels in mandelbrot_simd.hpp
+template <typename T>
+concept HasSimdKernels = requires(const T& value, std::span<uint32_t> out, MandelbrotStats& stats) {
+    MandelbrotRow(value, value, value, size_t{}, size_t{}, out, stats);
+};
+
+// Iterates runs of pixels of the task region with T
+template <typename T>
+class RegionEvaluator
+{
+public:
+    RegionEvaluator(ThreadTask& task, MandelbrotStats& stats)
+        : task_(task),
+          stats_(stats),
+          start_x_(RealCast<T>(task.world_start_point.x())),
+          start_y_(RealCast<T>(task.world_start_point.y())),
+          step_x_(RealCast<T>(task.world_step_per_pixel.x())),
+          step_y_(RealCast<T>(task.world_step_per_pixel.y()))
+    {
+    }
+
+    // Pixels [x, x + count) of row y
+    void ComputeRow(size_t x, size_t y, size_t count)
+    {
+        const T py = start_y_ + step_y_ * static_cast<T>(static_cast<double>(y));
+        const size_t width = task_.region_screen_size.x();
+        ForEachBatch(
+            count,
+            [&](size_t first, size_t batch_size)
+            {
+                const auto run = std::span{task_.pixels_iterations}.subspan(y * width + x + first, batch_size);
+                if constexpr (HasSimdKernels<T>)
+                {
+                    MandelbrotRow(start_x_, step_x_, py, task_.iterations, x + first, run, stats_);
+                }
+                else
+                {
+                    for (size_t index = 0; index != batch_size; ++index)
+                    {
+                        const T px = start_x_ + step_x_ * static_cast<T>(static_cast<double>(x + first + index));
+                        run[index] = static_cast<uint32_t>(MandelbrotLoop<T>(px, py, task_.iterations, stats_));
+                    }
+                }
+            });
+    }
+
+    // Pixels [y, y + count) of column x
+    void ComputeColumn(size_t x, size_t y, size_t count)
+    {
+        const T px = start_x_ + step_x_ * static_cast<T>(static_cast<double>(x));
+        run_iterations_.resize(count);
+        ForEachBatch(
+            count,
+            [&](size_t first, size_t batch_size)
+            {
+                const auto out = std::span{run_iterations_}.subspan(first, batch_size);
+                if constexpr (HasSimdKernels<T>)
+                {
+                    MandelbrotColumn(px, start_y_, step_y_, task_.iterations, y + first, out, stats_);
+                }
+                else
+                {
+                    for (size_t index = 0; index != batch_size; ++index)
+                    {
+                        const T py = start_y_ + step_y_ * static_cast<T>(static_cast<double>(y + first + index));
+                        out[index] = static_cast<uint32_t>(MandelbrotLoop<T>(px, py, task_.iterations, stats_));
+                    }
+                }
+            });
+
+        const size_t width = task_.region_screen_size.x();
+        for (size_t index = 0; index != count; ++index)
+        {
+            task_.pixels_iterations[(y + index) * width + x] = run_iterations_[index];
+        }
+    }
+
+    void ComputePixels(std::span<const PixelIndex> pixels)
+    {
+        run_iterations_.resize(pixels.size());
+        ForEachBatch(
+            pixels.size(),
+            [&](size_t first, size_t batch_size)
+            {
+                const auto batch = pixels.subspan(first, batch_size);
+                const auto out = std::span{run_iterations_}.subspan(first, batch_size);
+                if constexpr (HasSimdKernels<T>)
+                {
+                    MandelbrotPixels(start_x_, start_y_, step_x_, step_y_, task_.iterations, batch, out, stats_);
+                }
+                else
+                {
+                    for (size_t index = 0; index != batch_size; ++index)
+                    {
+                        const T px = start_x_ + step_x_ * static_cast<T>(static_cast<double>(batch[index].x));
+                        const T py = start_y_ + step_y_ * static_cast<T>(static_cast<double>(batch[index].y));
+                        out[index] = static_cast<uint32_t>(MandelbrotLoop<T>(px, py, task_.iterations, stats_));
+                    }
+                }
+            });
+
+        const size_t width = task_.region_screen_size.x();
+        for (size_t index = 0; index != pixels.size(); ++index)
+        {
+            task_.pixels_iterations[pixels[index].y * width + pixels[index].x] = run_iterations_[index];
+        }
+    }
+
+private:
+    // Vector kernels keep their lanes busy within a batch, the slow scalar types check every pixel
+    static constexpr size_t kBatchSize = HasSimdKernels<T> ? 64 : 1;
+
+    // Calls compute(first, size) for consecutive batches of count pixels until the task is cancelled
+    template <typename Compute>
+    void ForEachBatch(size_t count, Compute&& compute)
+    {
+        for (size_t first = 0; first < count; first += kBatchSize)
+        {
+            if (task_.IsCancelled())
+            {
+                task_.interrupted = true;
+                return;
+            }
+
+            const size_t batch_size = std::min(kBatchSize, count - first);
+            compute(first, batch_size);
+            stats_.pixels_computed += batch_size;
+        }
+    }
+
+private:
+    ThreadTask& task_;
+    MandelbrotStats& stats_;
+    // Results of runs that are not contiguous in the region
+    std::vector<uint32_t> run_iterations_;
+    T start_x_;
+    T start_y_;
+    T step_x_;
+    T step_y_;
+};
+
+// Perturbation works with offsets from the reference point which fit into double
+class PerturbationRegionEvaluator
+{
+public:
+    PerturbationRegionEvaluator(ThreadTask& task, const ReferenceOrbit& orbit, MandelbrotStats& stats)
+        : task_(task),
+          stats_(stats),
+          orbit_(orbit)
+    {
+        const Vector2f delta_start = task.world_start_point - task.perturbation->GetCenter();
+        delta_start_x_ = static_cast<double>(delta_start.x());
+        delta_start_y_ = static_cast<double>(delta_start.y());
+        step_x_ = static_cast<double>(task.world_step_per_pixel.x());
+        step_y_ = static_cast<double>(task.world_step_per_pixel.y());
+    }
+
+    // Pixels [x, x + count) of row y
+    void ComputeRow(size_t x, size_t y, size_t count)
+    {
+        for (size_t index = x; index != x + count; ++index)
+        {
+            ComputePixel(index, y);
+        }
+
+        stats_.pixels_computed += count;
+    }
+
+    // Pixels [y, y + count) of column x
+    void ComputeColumn(size_t x, size_t y, size_t count)
+    {
+        for (size_t index = y; index != y + count; ++index)
+        {
+            ComputePixel(x, index);
+        }
+
+        stats_.pixels_computed += count;
+    }
+
+    void ComputePixels(std::span<const PixelIndex> pixels)
+    {
+        for (const PixelIndex& pixel : pixels)
+        {
+            ComputePixel(pixel.x, pixel.y);
+        }
+
+        stats_.pixels_computed += pixels.size();
+    }
+
+private:
+    void ComputePixel(size_t x, size_t y)
+    {
+        if (task_.IsCancelled())
+        {
+            task_.interrupted = true;
+            return;
+        }
+
+        const double dcx = delta_start_x_ + step_x_ * static_cast<double>(x);
+        const double dcy = delta_start_y_ + step_y_ * static_cast<double>(y);
+        const size_t width = task_.region_screen_size.x();
+        task_.pixels_iterations[y * width + x] = static_cast<uint32_t>(orbit_.Iterate(dcx, dcy, task_.iterations));
+    }
+
+private:
+    ThreadTask& task_;
+    MandelbrotStats& stats_;
+    const ReferenceOrbit& orbit_;
+    double delta_start_x_ = 0.0;
+    double delta_start_y_ = 0.0;
+    double step_x_ = 0.0;
+    double step_y_ = 0.0;
+};
+
+// Fills the iterations of the task region with the algorithm of the task
+template <typename Evaluator>
+static void ComputeRegion(ThreadTask& task, Evaluator& evaluator, MandelbrotStats& stats)
+{
+    const size_t width = task.region_screen_size.x();
+    const size_t height = task.region_screen_size.y();
+    const IterationGrid grid{task.pixels_iterations, width, height};
+    switch (task.algorithm)
+    {
+    case FractalRenderAlgorithm::BruteForce:
+        // RunTask hands brute force tasks to FractalCPUWorkerPool::RunRows which splits them into row parts
+        throw std::logic_error("Brute force tasks are computed by RunRows");
+    case FractalRenderAlgorithm::MarianiSilver:
+        MarianiSilverFill(grid, evaluator, stats).Run();
+        break;
+    case FractalRenderAlgorithm::BoundaryTracing:
+        BoundaryTracingFill(grid, evaluator, stats).Run();
+        break;
+    case FractalRenderAlgorithm::SolidGuessing:
+        SolidGuessingFill(grid, evaluator, task.solid_guessing, task.passes_completed, stats).Run();
+        break;
+    case FractalRenderAlgorithm::Interleaved:
+        InterleavedFill(grid, evaluator, task.passes_completed).Run();
+        break;
+    }
+}
+
+// Calls callback with the evaluator for the precision of the task.
+// A stale task is marked as interrupted instead, it does not wait for the reference orbit of its frame.
+template <typename Callback>
+static void VisitEvaluator(ThreadTask& task, MandelbrotStats& stats, Callback&& callback)
+{
+    if (task.IsCancelled())
+    {
+        task.interrupted = true;
+        return;
+    }
+
+    if (task.perturbation)
+    {
+        const ReferenceOrbit* orbit = task.perturbation->GetOrbit(
+            [&task]
+            {
+                return task.IsCancelled();
+            });
+        if (!orbit)
+        {
+            task.interrupted = true;
+            return;
+        }
+
+        PerturbationRegionEvaluator evaluator(task, *orbit, stats);
+        callback(evaluator);
+        return;
+    }
+
+    auto visit = [&]<typename T>(std::type_identity<T>)
+    {
+        RegionEvaluator<T> evaluator(task, stats);
+        callback(evaluator);
+    };
+
+    switch (task.precision)
+    {
+    case FractalPrecision::Single:
+        visit(std::type_identity<float>{});
+        break;
+    case FractalPrecision::Double:
+        visit(std::type_identity<double>{});
+        break;
+    case FractalPrecision::DoubleDouble:
+        visit(std::type_identity<DoubleDouble>{});
+        break;
+    case FractalPrecision::QuadDouble:
+        visit(std::type_identity<QuadDouble>{});
+        break;
+    case FractalPrecision::Multiprecision:
+        VisitMultiFloat(task.multiprecision_digits, visit);
+        break;
+    }
+}
+
+static float GetSecondsSince(std::chrono::high_resolution_clock::time_point start_time)
+{
+    const auto end_time = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration_cast<std::chrono::duration<float>>(end_time - start_time).count();
+}
+
+FractalCPUWorkerPool::FractalCPUWorkerPool(size_t threads_count)
+{
+    workers_.resize(threads_count);
+    for (auto& worker : workers_)
+    {
+        worker = std::make_unique<Worker>();
+    }
+
+    threads_.reserve(threads_count);
+    for (size_t index = 0; index != threads_count; ++index)
+    {
+        threads_.emplace_back(&FractalCPUWorkerPool::thread_main, this, index);
+    }
+}
+
+FractalCPUWorkerPool::~FractalCPUWorkerPool()
+{
+    {
+        std::lock_guard lock(wake_mutex_);
+        must_stop_ = true;
+    }
+    wake_.notify_all();
+
+    for (std::thread& thread : threads_)
+    {
+        thread.join();
+    }
+}
+
+size_t FractalCPUWorkerPool::GetDefaultThreadsCount()
+{
+    return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+void FractalCPUWorkerPool::Push(ThreadTask* task)
+{
+    ++queued_;
+    Worker& worker = *workers_[next_worker_];
+    next_worker_ = (next_worker_ + 1) % workers_.size();
+    {
+        std::lock_guard lock(worker.mutex);
+        worker.tasks.push_back(task);
+    }
+
+    Wake(false);
+}
+
+void FractalCPUWorkerPool::Wake(bool all)
+{
+    // Taking the mutex orders the new epoch with a worker that is about to sleep
+    {
+        std::lock_guard lock(wake_mutex_);
+        ++wake_epoch_;
+    }
+
+    if (all)
+    {
+        wake_.notify_all();
+    }
+    else
+    {
+        wake_.notify_one();
+    }
+}
+
+ThreadTask* FractalCPUWorkerPool::TakeTask(size_t worker_index)
+{
+    {
+        Worker& worker = *workers_[worker_index];
+        std::lock_guard lock(worker.mutex);
+        if (!worker.tasks.empty())
+        {
+            ThreadTask* task = worker.tasks.front();
+            worker.tasks.pop_front();
+            --queued_;
+            return task;
+        }
+    }
+
+    for (size_t offset = 1; offset != workers_.size(); ++offset)
+    {
+        Worker& victim = *workers_[(worker_index + offset) % workers_.size()];
+        std::lock_guard lock(victim.mutex);
+        if (!victim.tasks.empty())
+        {
+            ThreadTask* task = victim.tasks.back();
+            victim.tasks.pop_back();
+            --queued_;
+            return task;
+        }
+    }
+
+    return nullptr;
+}
+
+ThreadTask* FractalCPUWorkerPool::SplitTask(size_t worker_index, size_t& first_row, size_t& end_row)
+{
+    // Pick the part with the most rows left, it is not locked so it may change before the split
+    Worker* largest = nullptr;
+    size_t largest_rows = 2 * kMinSplitRows - 1;
+    for (size_t offset = 1; offset != workers_.size(); ++offset)
+    {
+        Worker& victim = *workers_[(worker_index + offset) % workers_.size()];
+        std::lock_guard lock(victim.mutex);
+        if (victim.splittable_task && victim.end_row - victim.next_row > largest_rows)
+        {
+            largest = &victim;
+            largest_rows = victim.end_row - victim.next_row;
+        }
+    }
+
+    if (!largest)
+    {
+        return nullptr;
+    }
+
+    std::lock_guard lock(largest->mutex);
+    ThreadTask* task = largest->splittable_task;
+    if (!task || largest->end_row - largest->next_row < 2 * kMinSplitRows)
+    {
+        return nullptr;
+    }
+
+    // The victim has not finished its part, so the task can not complete before this part is registered
+    end_row = largest->end_row;
+    first_row = largest->next_row + (largest->end_row - largest->next_row) / 2;
+    largest->end_row = first_row;
+    ++task->parts_in_progress;
+    return task;
+}
+
+void FractalCPUWorkerPool::RunTask(Worker& worker, ThreadTask& task)
+{
+    const auto start_time = std::chrono::high_resolution_clock::now();
+    task.pixels_iterations.resize(task.region_screen_size.prod());
+    task.parts_in_progress = 1;
+
+    if (task.algorithm == FractalRenderAlgorithm::BruteForce)
+    {
+        RunRows(worker, task, 0, task.region_screen_size.y());
+        return;
+    }
+
+    // Other algorithms depend on pixels computed earlier and can not be split
+    MandelbrotStats stats;
+    VisitEvaluator(
+        task,
+        stats,
+        [&](auto& evaluator)
+        {
+            ComputeRegion(task, evaluator, stats);
+        });
+    FinishPart(task, stats, GetSecondsSince(start_time));
+}
+
+void FractalCPUWorkerPool::RunRows(Worker& worker, ThreadTask& task, size_t first_row, size_t end_row)
+{
+    const auto start_time = std::chrono::high_resolution_clock::now();
+    MandelbrotStats stats;
+    VisitEvaluator(
+        task,
+        stats,
+        [&](auto& evaluator)
+        {
+            {
+                std::lock_guard lock(worker.mutex);
+                worker.splittable_task = &task;
+                worker.next_row = first_row;
+                worker.end_row = end_row;
+            }
+
+            // Idle workers may help with this part
+            if (end_row - first_row >= 2 * kMinSplitRows)
+            {
+                Wake(true);
+            }
+
+            const size_t width = task.region_screen_size.x();
+            while (true)
+            {
+                size_t row = 0;
+                {
+                    std::lock_guard lock(worker.mutex);
+                    if (worker.next_row != worker.end_row && task.IsCancelled())
+                    {
+                        // Rows left in the part are never computed
+                        task.interrupted = true;
+                        worker.next_row = worker.end_row;
+                    }
+
+                    if (worker.next_row == worker.end_row)
+                    {
+                        worker.splittable_task = nullptr;
+                        break;
+                    }
+
+                    row = worker.next_row++;
+                }
+
+                evaluator.ComputeRow(0, row, width);
+                ++task.rows_completed;
+            }
+        });
+    FinishPart(task, stats, GetSecondsSince(start_time));
+}
+
+void FractalCPUWorkerPool::FinishPart(ThreadTask& task, const MandelbrotStats& stats, float duration_seconds)
+{
+    {
+        std::lock_guard lock(task.parts_mutex);
+        task.stats += stats;
+        task.task_duration_seconds += duration_seconds;
+    }
+
+    if (--task.parts_in_progress != 0)
+    {
+        return;
+    }
+
+    // Upload-ready colors so that the main thread only copies them to the texture.
+    // Tiles are resampled on the main thread and colorized after that.
+    if (!task.IsCancelled() && !task.tile)
+    {
+        const auto start_time = std::chrono::high_resolution_clock::now();
+        task.pixels_rgba.resize(task.pixels_iterations.size());
+        task.palette->Colorize(task.pixels_iterations, task.pixels_rgba);
+        task.task_duration_seconds += GetSecondsSince(start_time);
+    }
+
+    task.completed = true;
+}
+
+void FractalCPUWorkerPool::thread_main(size_t worker_index)
+{
+    // Tasks of a frame are pushed in a burst, polling a little longer avoids sleeping between them
+    constexpr size_t kSpinCount = 256;
+
+    Worker& worker = *workers_[worker_index];
+    size_t spin = 0;
+    while (true)
+    {
+        const uint64_t epoch = wake_epoch_;
+        if (ThreadTask* task = TakeTask(worker_index))
+        {
+            RunTask(worker, *task);
+            spin = 0;
+            continue;
+        }
+
+        size_t first_row = 0;
+        size_t end_row = 0;
+        if (ThreadTask* task = SplitTask(worker_index, first_row, end_row))
+        {
+            RunRows(worker, *task, first_row, end_row);
+            spin = 0;
+            continue;
+        }
+
+        if (spin != kSpinCount)
+        {
+            ++spin;
+            std::this_thread::yield();
+            continue;
+        }
+
+        spin = 0;
+        std::unique_lock lock(wake_mutex_);
+        wake_.wait(
+            lock,
+            [&]
+            {
+                return must_stop_ || wake_epoch_ != epoch;
+            });
+
+        if (must_stop_)
+        {
+            return;
+        }
+    }
+}
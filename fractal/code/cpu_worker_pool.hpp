@@ -0,0 +1,157 @@
+#pragma once
+
+#include <atomic>
+#include <concepts>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "mandelbrot.hpp"
+#include "palette.hpp"
+#include "precision.hpp"
+#include "render_algorithm.hpp"
+#include "solid_guessing.hpp"
+#include "tile_cache.hpp"
+#include "vector.hpp"
+#include "wrap_eigen.hpp"
+
+class PerturbationFrame;
+
+struct ThreadTask
+{
+    Vector2f world_start_point;
+    Vector2f world_step_per_pixel;
+    Eigen::Vector2<size_t> region_screen_location;
+    Eigen::Vector2<size_t> region_screen_size;
+    size_t iterations;
+    FractalPrecision precision = FractalPrecision::Double;
+    unsigned multiprecision_digits = 0;
+    FractalRenderAlgorithm algorithm = FractalRenderAlgorithm::BruteForce;
+    SolidGuessingOptions solid_guessing;
+    std::shared_ptr<PerturbationFrame> perturbation;
+    // Set for tiles of the tile cache: the task computes the whole tile and region_screen_location
+    // is only an approximate position used to order tasks
+    std::optional<TileKey> tile;
+    // Tile computed while idle for a view that may come next, it is not part of the frame
+    bool speculative = false;
+    std::vector<uint32_t> pixels_iterations;
+    // Workers colorize the region with this palette as the last step of the task
+    std::shared_ptr<const PaletteLut> palette;
+    std::vector<uint32_t> pixels_rgba;
+    std::atomic_bool completed = false;
+    std::atomic_bool cancelled = false;
+    // Frame of the task. The task is stale when the backend epoch moves on to the next frame.
+    uint64_t epoch = 0;
+    const std::atomic<uint64_t>* backend_epoch = nullptr;
+    // Some pixels were skipped because the task was cancelled
+    std::atomic_bool interrupted = false;
+    std::atomic<uint16_t> rows_completed = 0;
+    // Workers computing parts of the task. The last one to finish completes the task.
+    std::atomic<uint32_t> parts_in_progress = 0;
+    // Guards stats and task_duration_seconds which are summed over parts
+    std::mutex parts_mutex;
+    // Interleaved and solid guessing: passes computed by the worker and passes already shown by the main thread
+    std::atomic<uint8_t> passes_completed = 0;
+    uint8_t passes_displayed = 0;
+    float task_duration_seconds = 0.0f;
+    MandelbrotStats stats;
+
+    // Checked by workers between pixel batches
+    bool IsCancelled() const
+    {
+        return cancelled.load(std::memory_order_relaxed) ||
+               (backend_epoch && backend_epoch->load(std::memory_order_relaxed) != epoch);
+    }
+
+    // Every pixel of the completed task was computed. A cancelled task may complete with pixels skipped.
+    bool IsFullyComputed() const
+    {
+        return !interrupted && (algorithm != FractalRenderAlgorithm::BruteForce ||
+                                rows_completed == region_screen_size.y());
+    }
+};
+
+// Worker threads of the CPU backend. The app owns the pool so switching backends does not restart threads.
+// Tasks are distributed over per-worker deques. A worker takes tasks from the front of its deque and
+// steals from the back of other deques when its own is empty. When there is nothing to steal either,
+// it splits the remaining rows of the largest brute force task in progress in half.
+// An idle worker polls for a short time and then sleeps until a task is pushed or becomes splittable.
+class FractalCPUWorkerPool
+{
+public:
+    explicit FractalCPUWorkerPool(size_t threads_count = GetDefaultThreadsCount());
+    ~FractalCPUWorkerPool();
+
+    static size_t GetDefaultThreadsCount();
+
+    size_t GetThreadsCount() const
+    {
+        return threads_.size();
+    }
+
+    void Push(ThreadTask* task);
+
+    // Takes tasks that were not started by workers yet
+    template <typename Callback>
+    requires std::invocable<Callback, ThreadTask*>
+    void ConsumeAll(Callback&& callback)
+    {
+        for (auto& worker : workers_)
+        {
+            std::lock_guard lock(worker->mutex);
+            for (ThreadTask* task : worker->tasks)
+            {
+                callback(task);
+            }
+
+            queued_ -= worker->tasks.size();
+            worker->tasks.clear();
+        }
+    }
+
+    bool HasQueuedTasks() const
+    {
+        return queued_ != 0;
+    }
+
+private:
+    // Parts smaller than this are not split
+    static constexpr size_t kMinSplitRows = 2;
+
+    struct alignas(64) Worker
+    {
+        std::mutex mutex;
+        std::deque<ThreadTask*> tasks;
+        // Rows [next_row, end_row) of the brute force task in progress that are not taken yet
+        ThreadTask* splittable_task = nullptr;
+        size_t next_row = 0;
+        size_t end_row = 0;
+    };
+
+    void thread_main(size_t worker_index);
+    ThreadTask* TakeTask(size_t worker_index);
+    ThreadTask* SplitTask(size_t worker_index, size_t& first_row, size_t& end_row);
+    void RunTask(Worker& worker, ThreadTask& task);
+    void RunRows(Worker& worker, ThreadTask& task, size_t first_row, size_t end_row);
+    static void FinishPart(ThreadTask& task, const MandelbrotStats& stats, float duration_seconds);
+    void Wake(bool all);
+
+private:
+    std::vector<std::unique_ptr<Worker>> workers_;
+    size_t next_worker_ = 0;
+    // Incremented before a task is pushed and decremented after it is taken, so it never
+    // underestimates the queues
+    std::atomic<size_t> queued_ = 0;
+    // Changes when there is new work, a worker that saw the old value does not sleep
+    std::atomic<uint64_t> wake_epoch_ = 0;
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    bool must_stop_ = false;
+    std::vector<std::thread> threads_;
+};
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+#include "error_free_transform.hpp"
+
+// Unevaluated sum of two doubles with about 106 significant bits (~1e-31 relative precision).
+// Arithmetic follows the QD library by Hida, Li and Bailey.
+class DoubleDouble
+{
+public:
+    constexpr DoubleDouble() = default;
+
+    constexpr DoubleDouble(double value) : hi(value) {}
+
+    constexpr DoubleDouble(double in_hi, double in_lo) : hi(in_hi), lo(in_lo) {}
+
+    // Rounds any type convertible to double with higher precision (i.e. Float)
+    template <typename Number>
+        requires(!std::is_arithmetic_v<Number>)
+    static DoubleDouble FromNumber(const Number& value)
+    {
+        const auto value_hi = static_cast<double>(value);
+        const auto value_lo = static_cast<double>(value - Number(value_hi));
+        double error = 0.0;
+        const double sum = QuickTwoSum(value_hi, value_lo, error);
+        return {sum, error};
+    }
+
+    explicit operator double() const
+    {
+        return hi + lo;
+    }
+
+    DoubleDouble operator-() const
+    {
+        return {-hi, -lo};
+    }
+
+    DoubleDouble& operator+=(const DoubleDouble& other)
+    {
+        double s2 = 0.0;
+        double t2 = 0.0;
+        double s1 = TwoSum(hi, other.hi, s2);
+        const double t1 = TwoSum(lo, other.lo, t2);
+        s2 += t1;
+        s1 = QuickTwoSum(s1, s2, s2);
+        s2 += t2;
+        hi = QuickTwoSum(s1, s2, lo);
+        return *this;
+    }
+
+    DoubleDouble& operator-=(const DoubleDouble& other)
+    {
+        return *this += -other;
+    }
+
+    DoubleDouble& operator*=(const DoubleDouble& other)
+    {
+        double p2 = 0.0;
+        const double p1 = TwoProduct(hi, other.hi, p2);
+        p2 += hi * other.lo + lo * other.hi;
+        hi = QuickTwoSum(p1, p2, lo);
+        return *this;
+    }
+
+    DoubleDouble& operator/=(const DoubleDouble& other)
+    {
+        // Long division: two correction steps on top of the double quotient
+        const double q1 = hi / other.hi;
+        DoubleDouble r = *this - other * q1;
+        const double q2 = r.hi / other.hi;
+        r -= other * q2;
+        const double q3 = r.hi / other.hi;
+        double q2_error = 0.0;
+        const double q12 = QuickTwoSum(q1, q2, q2_error);
+        *this = DoubleDouble(q12, q2_error) + q3;
+        return *this;
+    }
+
+    friend DoubleDouble operator+(DoubleDouble a, const DoubleDouble& b)
+    {
+        return a += b;
+    }
+
+    friend DoubleDouble operator-(DoubleDouble a, const DoubleDouble& b)
+    {
+        return a -= b;
+    }
+
+    friend DoubleDouble operator*(DoubleDouble a, const DoubleDouble& b)
+    {
+        return a *= b;
+    }
+
+    friend DoubleDouble operator/(DoubleDouble a, const DoubleDouble& b)
+    {
+        return a /= b;
+    }
+
+    friend bool operator==(const DoubleDouble& a, const DoubleDouble& b)
+    {
+        return !(a < b) && !(b < a);
+    }
+
+    friend bool operator<(const DoubleDouble& a, const DoubleDouble& b)
+    {
+        return a.hi < b.hi || (a.hi <= b.hi && a.lo < b.lo);
+    }
+
+    friend bool operator<=(const DoubleDouble& a, const DoubleDouble& b)
+    {
+        return a.hi < b.hi || (a.hi <= b.hi && a.lo <= b.lo);
+    }
+
+    friend bool operator>(const DoubleDouble& a, const DoubleDouble& b)
+    {
+        return b < a;
+    }
+
+    friend bool operator>=(const DoubleDouble& a, const DoubleDouble& b)
+    {
+        return b <= a;
+    }
+
+    double hi = 0.0;
+    double lo = 0.0;
+};
+
+// Lets DoubleDouble be used as coordinates (see CoordinateReal)
+template <>
+class std::numeric_limits<DoubleDouble>
+{
+public:
+    static constexpr bool is_specialized = true;
+    static constexpr bool is_signed = true;
+    static constexpr bool is_integer = false;
+    static constexpr bool is_exact = false;
+    static constexpr int radix = 2;
+    static constexpr int digits = 2 * std::numeric_limits<double>::digits;
+    static constexpr int digits10 = digits * 301 / 1000;
+
+    static DoubleDouble epsilon()
+    {
+        return std::ldexp(1.0, 1 - digits);
+    }
+
+    static DoubleDouble max()
+    {
+        return std::numeric_limits<double>::max();
+    }
+
+    static DoubleDouble lowest()
+    {
+        return std::numeric_limits<double>::lowest();
+    }
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cmath>
+
+// Error-free transformations: each returns the rounded result and stores the exact rounding error
+// in `error`, so that result + error == exact result of the operation.
+
+// Requires |a| >= |b| or a == 0
+inline double QuickTwoSum(double a, double b, double& error)
+{
+    const double s = a + b;
+    error = b - (s - a);
+    return s;
+}
+
+inline double TwoSum(double a, double b, double& error)
+{
+    const double s = a + b;
+    const double bb = s - a;
+    error = (a - (s - bb)) + (b - bb);
+    return s;
+}
+
+#ifdef __FMA__
+
+inline double TwoProduct(double a, double b, double& error)
+{
+    const double p = a * b;
+    error = std::fma(a, b, -p);
+    return p;
+}
+
+#else
+
+// Dekker's split of a double into two halves with 26 significant bits each
+inline void SplitDouble(double a, double& hi, double& lo)
+{
+    constexpr double kSplitter = 134217729.0;  // 2^27 + 1
+    const double t = kSplitter * a;
+    hi = t - (t - a);
+    lo = a - hi;
+}
+
+inline double TwoProduct(double a, double b, double& error)
+{
+    const double p = a * b;
+    double a_hi = 0.0;
+    double a_lo = 0.0;
+    double b_hi = 0.0;
+    double b_lo = 0.0;
+    SplitDouble(a, a_hi, a_lo);
+    SplitDouble(b, b_hi, b_lo);
+    error = ((a_hi * b_hi - p) + a_hi * b_lo + a_lo * b_hi) + a_lo * b_lo;
+    return p;
+}
+
+#endif
@@ -0,0 +1,368 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+// Binary fixed point number stored in kLimbs 64-bit limbs (two's complement, least significant limb first).
+// The top 16 bits are the integer part (including sign) so the range is [-32768, 32768).
+// That covers the Mandelbrot recurrence (|z| <= 2 plus one escaping step) and pixel coordinates.
+// Requires unsigned __int128 (GCC and Clang).
+template <size_t kLimbs>
+class FixedPoint
+{
+    static_assert(kLimbs >= 2);
+
+    __extension__ typedef unsigned __int128 UInt128;
+
+public:
+    static constexpr unsigned kIntegerBits = 16;
+    static constexpr unsigned kFractionBits = 64 * kLimbs - kIntegerBits;
+
+    using Limbs = std::array<uint64_t, kLimbs>;
+
+    constexpr FixedPoint() = default;
+
+    constexpr FixedPoint(int value)
+    {
+        limbs_[kLimbs - 1] = static_cast<uint64_t>(static_cast<int64_t>(value)) << (64 - kIntegerBits);
+    }
+
+    explicit FixedPoint(double value) : FixedPoint(FromNumber(value)) {}
+
+    // Truncates any number type with floor and ldexp (double, boost::multiprecision)
+    template <typename Number>
+    static FixedPoint FromNumber(const Number& value)
+    {
+        using std::floor;
+        using std::ldexp;
+
+        const bool negative = value < 0;
+        Number rest = negative ? Number(-value) : Number(value);
+        rest = ldexp(rest, 64 - static_cast<int>(kIntegerBits));
+
+        FixedPoint result;
+        for (size_t index = kLimbs; index-- != 0;)
+        {
+            const Number limb = floor(rest);
+            result.limbs_[index] = static_cast<uint64_t>(limb);
+            rest = ldexp(Number(rest - limb), 64);
+        }
+
+        return negative ? -result : result;
+    }
+
+    explicit operator double() const
+    {
+        const bool negative = IsNegative();
+        const FixedPoint magnitude = negative ? -*this : *this;
+        double result = 0.0;
+        for (size_t index = 0; index != kLimbs; ++index)
+        {
+            const int exponent = static_cast<int>(64 * index) - static_cast<int>(kFractionBits);
+            result += std::ldexp(static_cast<double>(magnitude.limbs_[index]), exponent);
+        }
+
+        return negative ? -result : result;
+    }
+
+    bool IsNegative() const
+    {
+        return (limbs_[kLimbs - 1] >> 63) != 0;
+    }
+
+    const Limbs& GetLimbs() const
+    {
+        return limbs_;
+    }
+
+    FixedPoint operator-() const
+    {
+        FixedPoint result;
+        uint64_t carry = 1;
+        for (size_t index = 0; index != kLimbs; ++index)
+        {
+            const UInt128 sum = static_cast<UInt128>(~limbs_[index]) + carry;
+            result.limbs_[index] = static_cast<uint64_t>(sum);
+            carry = static_cast<uint64_t>(sum >> 64);
+        }
+
+        return result;
+    }
+
+    FixedPoint& operator+=(const FixedPoint& other)
+    {
+        uint64_t carry = 0;
+        for (size_t index = 0; index != kLimbs; ++index)
+        {
+            const UInt128 sum = static_cast<UInt128>(limbs_[index]) + other.limbs_[index] + carry;
+            limbs_[index] = static_cast<uint64_t>(sum);
+            carry = static_cast<uint64_t>(sum >> 64);
+        }
+
+        return *this;
+    }
+
+    FixedPoint& operator-=(const FixedPoint& other)
+    {
+        uint64_t borrow = 0;
+        for (size_t index = 0; index != kLimbs; ++index)
+        {
+            const UInt128 difference = static_cast<UInt128>(limbs_[index]) - other.limbs_[index] - borrow;
+            limbs_[index] = static_cast<uint64_t>(difference);
+            borrow = static_cast<uint64_t>(difference >> 64) & 1;
+        }
+
+        return *this;
+    }
+
+    FixedPoint& operator*=(const FixedPoint& other)
+    {
+        *this = *this * other;
+        return *this;
+    }
+
+    FixedPoint& operator/=(const FixedPoint& other)
+    {
+        *this = *this / other;
+        return *this;
+    }
+
+    friend FixedPoint operator+(FixedPoint a, const FixedPoint& b)
+    {
+        return a += b;
+    }
+
+    friend FixedPoint operator-(FixedPoint a, const FixedPoint& b)
+    {
+        return a -= b;
+    }
+
+    // x * x is detected by address and computed with the cheaper squaring
+    friend FixedPoint operator*(const FixedPoint& a, const FixedPoint& b)
+    {
+        if (&a == &b)
+        {
+            return Square(a);
+        }
+
+        const bool negative = a.IsNegative() != b.IsNegative();
+        const FixedPoint abs_a = a.IsNegative() ? -a : a;
+        const FixedPoint abs_b = b.IsNegative() ? -b : b;
+
+        std::array<uint64_t, 2 * kLimbs> product{};
+        for (size_t i = 0; i != kLimbs; ++i)
+        {
+            uint64_t carry = 0;
+            for (size_t j = 0; j != kLimbs; ++j)
+            {
+                const UInt128 t = static_cast<UInt128>(abs_a.limbs_[i]) * abs_b.limbs_[j] + product[i + j] + carry;
+                product[i + j] = static_cast<uint64_t>(t);
+                carry = static_cast<uint64_t>(t >> 64);
+            }
+            product[i + kLimbs] = carry;
+        }
+
+        const FixedPoint result = FromProduct(product);
+        return negative ? -result : result;
+    }
+
+    // Cross products a[i] * a[j] are computed once and doubled
+    friend FixedPoint Square(const FixedPoint& a)
+    {
+        const FixedPoint abs_a = a.IsNegative() ? -a : a;
+        const Limbs& l = abs_a.limbs_;
+
+        std::array<uint64_t, 2 * kLimbs> product{};
+        for (size_t i = 0; i != kLimbs; ++i)
+        {
+            uint64_t carry = 0;
+            for (size_t j = i + 1; j != kLimbs; ++j)
+            {
+                const UInt128 t = static_cast<UInt128>(l[i]) * l[j] + product[i + j] + carry;
+                product[i + j] = static_cast<uint64_t>(t);
+                carry = static_cast<uint64_t>(t >> 64);
+            }
+            product[i + kLimbs] = carry;
+        }
+
+        uint64_t shifted_out = 0;
+        for (uint64_t& limb : product)
+        {
+            const uint64_t next_shifted_out = limb >> 63;
+            limb = (limb << 1) | shifted_out;
+            shifted_out = next_shifted_out;
+        }
+
+        uint64_t carry = 0;
+        for (size_t i = 0; i != kLimbs; ++i)
+        {
+            const UInt128 diagonal = static_cast<UInt128>(l[i]) * l[i];
+            UInt128 t = static_cast<UInt128>(product[2 * i]) + static_cast<uint64_t>(diagonal) + carry;
+            product[2 * i] = static_cast<uint64_t>(t);
+            t = static_cast<UInt128>(product[2 * i + 1]) + static_cast<uint64_t>(diagonal >> 64) + (t >> 64);
+            product[2 * i + 1] = static_cast<uint64_t>(t);
+            carry = static_cast<uint64_t>(t >> 64);
+        }
+
+        return FromProduct(product);
+    }
+
+    // Restoring binary long division. Much slower than multiplication, not meant for inner loops.
+    friend FixedPoint operator/(const FixedPoint& a, const FixedPoint& b)
+    {
+        const bool negative = a.IsNegative() != b.IsNegative();
+        const FixedPoint abs_a = a.IsNegative() ? -a : a;
+        const FixedPoint abs_b = b.IsNegative() ? -b : b;
+
+        // Numerator is abs_a << kFractionBits, quotient bits above the fixed point range are dropped
+        constexpr size_t kNumeratorBits = 64 * kLimbs + kFractionBits;
+        auto numerator_bit = [&](size_t bit)
+        {
+            if (bit < kFractionBits) return uint64_t{0};
+            const size_t source_bit = bit - kFractionBits;
+            return (abs_a.limbs_[source_bit / 64] >> (source_bit % 64)) & 1;
+        };
+
+        std::array<uint64_t, kLimbs + 1> remainder{};
+        FixedPoint quotient;
+        for (size_t bit = kNumeratorBits; bit-- != 0;)
+        {
+            uint64_t shifted_out = numerator_bit(bit);
+            for (uint64_t& limb : remainder)
+            {
+                const uint64_t next_shifted_out = limb >> 63;
+                limb = (limb << 1) | shifted_out;
+                shifted_out = next_shifted_out;
+            }
+
+            if (!IsLess(remainder, abs_b.limbs_))
+            {
+                uint64_t borrow = 0;
+                for (size_t index = 0; index != remainder.size(); ++index)
+                {
+                    const uint64_t subtrahend = index < kLimbs ? abs_b.limbs_[index] : 0;
+                    const UInt128 difference = static_cast<UInt128>(remainder[index]) - subtrahend - borrow;
+                    remainder[index] = static_cast<uint64_t>(difference);
+                    borrow = static_cast<uint64_t>(difference >> 64) & 1;
+                }
+
+                if (bit < 64 * kLimbs)
+                {
+                    quotient.limbs_[bit / 64] |= uint64_t{1} << (bit % 64);
+                }
+            }
+        }
+
+        return negative ? -quotient : quotient;
+    }
+
+    friend bool operator==(const FixedPoint& a, const FixedPoint& b)
+    {
+        return a.limbs_ == b.limbs_;
+    }
+
+    friend bool operator<(const FixedPoint& a, const FixedPoint& b)
+    {
+        const auto a_top = static_cast<int64_t>(a.limbs_[kLimbs - 1]);
+        const auto b_top = static_cast<int64_t>(b.limbs_[kLimbs - 1]);
+        if (a_top != b_top)
+        {
+            return a_top < b_top;
+        }
+
+        for (size_t index = kLimbs - 1; index-- != 0;)
+        {
+            if (a.limbs_[index] != b.limbs_[index])
+            {
+                return a.limbs_[index] < b.limbs_[index];
+            }
+        }
+
+        return false;
+    }
+
+    friend bool operator>(const FixedPoint& a, const FixedPoint& b)
+    {
+        return b < a;
+    }
+
+    friend bool operator<=(const FixedPoint& a, const FixedPoint& b)
+    {
+        return !(b < a);
+    }
+
+    friend bool operator>=(const FixedPoint& a, const FixedPoint& b)
+    {
+        return !(a < b);
+    }
+
+private:
+    // Takes bits [kFractionBits, kFractionBits + 64 * kLimbs) of an unsigned product
+    static FixedPoint FromProduct(const std::array<uint64_t, 2 * kLimbs>& product)
+    {
+        constexpr unsigned kShift = 64 - kIntegerBits;
+        FixedPoint result;
+        for (size_t index = 0; index != kLimbs; ++index)
+        {
+            result.limbs_[index] =
+                (product[index + kLimbs - 1] >> kShift) | (product[index + kLimbs] << (64 - kShift));
+        }
+
+        return result;
+    }
+
+    // Unsigned comparison of a remainder with one extra limb against a magnitude
+    static bool IsLess(const std::array<uint64_t, kLimbs + 1>& a, const Limbs& b)
+    {
+        if (a[kLimbs] != 0)
+        {
+            return false;
+        }
+
+        for (size_t index = kLimbs; index-- != 0;)
+        {
+            if (a[index] != b[index])
+            {
+                return a[index] < b[index];
+            }
+        }
+
+        return false;
+    }
+
+private:
+    Limbs limbs_{};
+};
+
+// Lets FixedPoint be used as coordinates (see CoordinateReal). Unlike floating point types the spacing of
+// values is epsilon everywhere and the range is small, max() is rounded down to a whole number.
+template <size_t kLimbs>
+class std::numeric_limits<FixedPoint<kLimbs>>
+{
+public:
+    static constexpr bool is_specialized = true;
+    static constexpr bool is_signed = true;
+    static constexpr bool is_integer = false;
+    static constexpr bool is_exact = true;
+    static constexpr int radix = 2;
+    static constexpr int digits = static_cast<int>(64 * kLimbs) - 1;
+    static constexpr int digits10 = digits * 301 / 1000;
+
+    static FixedPoint<kLimbs> epsilon()
+    {
+        return FixedPoint<kLimbs>(std::ldexp(1.0, -static_cast<int>(FixedPoint<kLimbs>::kFractionBits)));
+    }
+
+    static FixedPoint<kLimbs> max()
+    {
+        return FixedPoint<kLimbs>(std::ldexp(1.0, static_cast<int>(FixedPoint<kLimbs>::kIntegerBits) - 1) - 1.0);
+    }
+
+    static FixedPoint<kLimbs> lowest()
+    {
+        return -max();
+    }
+};
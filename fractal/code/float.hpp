@@ -1,33 +1,75 @@
 #pragma once
 
+#include <array>
+#include <string_view>
+#include <type_traits>
+
+// Multiprecision backend is selected at build time (see FRACTAL_FLOAT_BACKEND in CMakeLists.txt).
+// A custom backend is a header passed as FRACTAL_FLOAT_BACKEND_HEADER. It has to define
+// `template <unsigned kDigits> using FloatBackend` as a boost::multiprecision backend with at least
+// kDigits decimal digits and `inline constexpr std::string_view kFloatBackendName`.
+#if defined(FRACTAL_FLOAT_BACKEND_HEADER)
+#include "boost/multiprecision/number.hpp"
+#include FRACTAL_FLOAT_BACKEND_HEADER
+#elif FRACTAL_FLOAT_BINARY
+#include "boost/multiprecision/cpp_bin_float.hpp"
+template <unsigned kDigits>
+using FloatBackend = boost::multiprecision::cpp_bin_float<kDigits>;
+inline constexpr std::string_view kFloatBackendName = "cpp_bin_float";
+#else
 #include "boost/multiprecision/cpp_dec_float.hpp"
+template <unsigned kDigits>
+using FloatBackend = boost::multiprecision::cpp_dec_float<kDigits>;
+inline constexpr std::string_view kFloatBackendName = "cpp_dec_float";
+#endif
 
-using Float = boost::multiprecision::number<boost::multiprecision::cpp_dec_float<100>>;
+#if FRACTAL_FLOAT_EXPRESSION_TEMPLATES
+inline constexpr auto kFloatExpressionTemplates = boost::multiprecision::et_on;
+#else
+inline constexpr auto kFloatExpressionTemplates = boost::multiprecision::et_off;
+#endif
 
-inline Float operator*(const Float& a, const Float& b)
-{
-    Float copy = a;
-    copy *= b;
-    return copy;
-}
+// Fixed precision floats used to iterate pixels when hardware types are not enough
+template <unsigned kDigits>
+using MultiFloat = boost::multiprecision::number<FloatBackend<kDigits>, boost::multiprecision::et_off>;
 
-inline Float operator/(const Float& a, const Float& b)
-{
-    Float copy = a;
-    copy /= b;
-    return copy;
-}
+inline constexpr std::array<unsigned, 5> kMultiFloatDigits{50, 100, 200, 400, 1000};
 
-inline Float operator-(const Float& a, const Float& b)
-{
-    Float copy = a;
-    copy -= b;
-    return copy;
-}
+// Camera and frame coordinates. Every zoom, pan and task setup computes with them, so they are kept
+// narrow. Zoom stops where they no longer tell pixels apart (see FractalSettings::GetMaxZoom).
+// Wider MultiFloat tiers still pay off below that depth because iterations accumulate errors.
+// The type is selected at build time (see FRACTAL_COORDINATE_TYPE in CMakeLists.txt). Any CoordinateReal
+// from real_traits.hpp works. A custom header passed as FRACTAL_COORDINATE_HEADER has to define
+// `using Float` and `inline constexpr std::string_view kFloatName`.
+#if defined(FRACTAL_COORDINATE_HEADER)
+#include FRACTAL_COORDINATE_HEADER
+#elif FRACTAL_COORDINATE_DOUBLE_DOUBLE
+#include "double_double.hpp"
+using Float = DoubleDouble;
+inline constexpr std::string_view kFloatName = "double-double";
+#elif FRACTAL_COORDINATE_QUAD_DOUBLE
+#include "quad_double.hpp"
+using Float = QuadDouble;
+inline constexpr std::string_view kFloatName = "quad-double";
+#elif FRACTAL_COORDINATE_FIXED_POINT
+#include "fixed_point.hpp"
+// 368 fraction bits, a little more than 100 decimal digits
+using Float = FixedPoint<6>;
+inline constexpr std::string_view kFloatName = "fixed-point";
+#else
+inline constexpr unsigned kFloatDigits = 100;
+using Float = boost::multiprecision::number<FloatBackend<kFloatDigits>, kFloatExpressionTemplates>;
+inline constexpr std::string_view kFloatName = kFloatBackendName;
+#endif
 
-inline Float operator+(const Float& a, const Float& b)
+// Calls callback with std::type_identity of the narrowest MultiFloat that has at least `digits` digits
+template <typename Callback>
+decltype(auto) VisitMultiFloat(unsigned digits, Callback&& callback)
 {
-    Float copy = a;
-    copy += b;
-    return copy;
+    static_assert(kMultiFloatDigits.size() == 5);
+    if (digits <= kMultiFloatDigits[0]) return callback(std::type_identity<MultiFloat<kMultiFloatDigits[0]>>{});
+    if (digits <= kMultiFloatDigits[1]) return callback(std::type_identity<MultiFloat<kMultiFloatDigits[1]>>{});
+    if (digits <= kMultiFloatDigits[2]) return callback(std::type_identity<MultiFloat<kMultiFloatDigits[2]>>{});
+    if (digits <= kMultiFloatDigits[3]) return callback(std::type_identity<MultiFloat<kMultiFloatDigits[3]>>{});
+    return callback(std::type_identity<MultiFloat<kMultiFloatDigits[4]>>{});
 }
@@ -1,17 +1,34 @@
 #pragma once
 
-#include "klgl/wrap/wrap_eigen.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <random>
+
+#include "precision.hpp"
+#include "real_traits.hpp"
+#include "render_algorithm.hpp"
 #include "vector.hpp"
+#include "wrap_eigen.hpp"
 
-struct FractalSettings
+// View and render settings. Coordinates are Real, the app and the engine use FractalSettings with Float.
+template <CoordinateReal Real>
+struct BasicFractalSettings
 {
+    using Coordinates = Vector<Real, 2>;
+
     constexpr static size_t colors_count = 10;
 
-    FractalSettings()
+    // Single precision SIMD kernels count iterations in float which is exact up to 2^24
+    constexpr static uint32_t max_iterations_limit = 1u << 24;
+
+    BasicFractalSettings()
     {
-        camera_.Fill(0);
-        scale_factor_ = Float(0.95);
-        pan_speed_ = 0.1;
+        camera_.Fill(Real(0));
+        scale_factor_ = Real(0.95);
+        pan_speed_ = Real(0.1);
         width_ = 800;
         height_ = 800;
 
@@ -20,8 +37,11 @@ struct FractalSettings
 
     void IncrementScale()
     {
-        ++zoom_;
-        Update();
+        if (zoom_ < GetMaxZoom())
+        {
+            ++zoom_;
+            Update();
+        }
     }
 
     void DecrementScale()
@@ -33,19 +53,19 @@ struct FractalSettings
         }
     }
 
-    void ShiftCameraX(const Float& delta)
+    void ShiftCameraX(const Real& delta)
     {
         camera_.x() += delta;
         settings_applied = false;
     }
 
-    void ShiftCameraY(const Float& delta)
+    void ShiftCameraY(const Real& delta)
     {
         camera_.y() += delta;
         settings_applied = false;
     }
 
-    const Float& GetScale() const
+    const Real& GetScale() const
     {
         return scale_;
     }
@@ -74,26 +94,40 @@ struct FractalSettings
         return zoom_;
     }
 
-    const Vector2f& GetCoordRange() const
+    // Deepest zoom at which Real coordinates of neighbor pixels are still far apart for the viewport size.
+    // Deeper zoom values are clamped to it.
+    uint16_t GetMaxZoom() const;
+
+    size_t GetViewportWidth() const
+    {
+        return width_;
+    }
+
+    size_t GetViewportHeight() const
+    {
+        return height_;
+    }
+
+    const Coordinates& GetCoordRange() const
     {
         return coord_range_;
     }
 
-    const Vector2f& GetStepPerPixel() const
+    const Coordinates& GetStepPerPixel() const
     {
         return step_per_pixel_;
     }
 
-    Vector2f GetCoordAtPixel(size_t x, size_t y) const;
+    Coordinates GetCoordAtPixel(size_t x, size_t y) const;
 
     void MoveCameraToPixel(const size_t x, const size_t y, bool flip_y);
 
-    const Vector2f& GetCamera() const
+    const Coordinates& GetCamera() const
     {
         return camera_;
     }
 
-    void SetCamera(const Vector2f& camera, bool check_not_same = true)
+    void SetCamera(const Coordinates& camera, bool check_not_same = true)
     {
         if (check_not_same && camera.x() == camera_.x() && camera.y() == camera_.y())
         {
@@ -113,24 +147,190 @@ struct FractalSettings
 
     void PanCamera(const PanCameraOpts opts);
 
+    // Palette colors generated from color_seed
+    void RandomizeColors();
+
+    uint32_t max_iterations = 1000;
     int color_seed = 1234;
     std::array<Eigen::Vector3f, colors_count> colors;
     bool settings_applied = false;
-    bool use_double = true;
+    // Palette changes only need the CPU backend to recolor retained iterations
+    bool colors_applied = false;
+    bool auto_precision = true;
+    FractalPrecision precision = FractalPrecision::Double;
+    FractalRenderAlgorithm render_algorithm = FractalRenderAlgorithm::BruteForce;
+    int solid_guessing_aggressiveness = 2;
+    bool verify_solid_guessing = false;
+    bool use_perturbation = false;
+    bool use_series_approximation = true;
+    // Compose frames from world-aligned tiles kept in memory between frames
+    bool use_tile_cache = false;
+    int tile_cache_budget_mb = 256;
+    // Also keep tiles in a memory mapped store on disk shared by app instances
+    bool persist_tiles = false;
+    // Compute tiles of likely next views (zoom in/out, pan) while the frame is complete
+    bool speculative_tiles = true;
+    // Pixel under the mouse cursor while it is over the viewport, y goes down like in MoveCameraToPixel with flip_y
+    std::optional<Eigen::Vector2<size_t>> cursor_pixel;
 
 private:
     void Update();
 
+    static Real FromSize(size_t value)
+    {
+        return Real(static_cast<double>(value));
+    }
+
 private:
-    Float scale_;
-    Float scale_factor_;
+    // A pixel spans at least this many units in the last place of a coordinate,
+    // so that rounding of task start points stays far below the pixel size
+    static constexpr int kCoordinateGuardBits = 8;
+
+    Real scale_;
+    Real scale_factor_;
     uint16_t zoom_ = 0;
-    Vector2f coord_range_;
-    Vector2f min_coord_;
-    Vector2f max_coord_;
-    Vector2f step_per_pixel_;
+    Coordinates coord_range_;
+    Coordinates min_coord_;
+    Coordinates max_coord_;
+    Coordinates step_per_pixel_;
     size_t width_;
     size_t height_;
-    Float pan_speed_;
-    Vector2f camera_;
+    Real pan_speed_;
+    Coordinates camera_;
 };
+
+template <CoordinateReal Real>
+void BasicFractalSettings<Real>::Update()
+{
+    settings_applied = false;
+    zoom_ = std::min(zoom_, GetMaxZoom());
+
+    scale_ = RealTraits<Real>::Pow(scale_factor_, zoom_);
+
+    Coordinates offset;
+    offset.Fill(scale_ * Real(2));
+
+    if (width_ != height_)
+    {
+        if (width_ > height_)
+        {
+            offset.x() *= FromSize(width_) / FromSize(height_);
+        }
+        else
+        {
+            offset.y() *= FromSize(height_) / FromSize(width_);
+        }
+    }
+
+    min_coord_ = camera_;
+    min_coord_ -= offset;
+    max_coord_ = camera_;
+    max_coord_ += offset;
+    coord_range_ = offset * Real(2);
+
+    step_per_pixel_ = coord_range_;
+    step_per_pixel_.x() /= FromSize(width_);
+    step_per_pixel_.y() /= FromSize(height_);
+}
+
+template <CoordinateReal Real>
+void BasicFractalSettings<Real>::MoveCameraToPixel(const size_t x, const size_t y, bool flip_y)
+{
+    Coordinates p;
+    p.x() = FromSize(x);
+    p.x() /= FromSize(width_);
+
+    if (flip_y)
+    {
+        p.y() = FromSize(height_);
+        p.y() -= FromSize(y);
+    }
+    else
+    {
+        p.y() = FromSize(y);
+    }
+    p.y() /= FromSize(height_);
+    p *= coord_range_;
+    p += min_coord_;
+    SetCamera(p);
+}
+
+template <CoordinateReal Real>
+void BasicFractalSettings<Real>::PanCamera(const PanCameraOpts opts)
+{
+    if (opts.dir_x == 0 && opts.dir_y == 0)
+    {
+        return;
+    }
+
+    std::array<int, 2> dirs{opts.dir_x, opts.dir_y};
+    std::array<size_t, 2> pixels_count{width_, height_};
+
+    for (size_t index = 0; index != 2; ++index)
+    {
+        if (const int dir = dirs[index]; dir != 0)
+        {
+            // Whole pixels so that the CPU backend shifts the previous frame instead of recomputing it
+            Real pixels = RealTraits<Real>::Round(pan_speed_ * Real(static_cast<double>(opts.dt)) * FromSize(pixels_count[index]));
+            if (pixels < Real(1))
+            {
+                pixels = Real(1);
+            }
+
+            if (dir > 0)
+            {
+                camera_[index] += pixels * step_per_pixel_[index];
+            }
+            else
+            {
+                camera_[index] -= pixels * step_per_pixel_[index];
+            }
+        }
+    }
+
+    Update();
+}
+
+template <CoordinateReal Real>
+uint16_t BasicFractalSettings<Real>::GetMaxZoom() const
+{
+    // Interesting coordinates are within |c| <= 2, so their unit in the last place is at most 2 * epsilon
+    const int epsilon_exponent = RealTraits<Real>::GetExponent(std::numeric_limits<Real>::epsilon());
+    const int min_pixel_exponent = epsilon_exponent + 1 + kCoordinateGuardBits;
+
+    // Pixels are 4 * scale_factor^zoom / min(width, height) wide
+    const double min_side = static_cast<double>(std::min(width_, height_));
+    const double max_zoom =
+        (min_pixel_exponent - std::log2(4.0 / min_side)) / std::log2(static_cast<double>(scale_factor_));
+    return static_cast<uint16_t>(std::clamp(std::floor(max_zoom), 0.0, double{std::numeric_limits<uint16_t>::max()}));
+}
+
+template <CoordinateReal Real>
+auto BasicFractalSettings<Real>::GetCoordAtPixel(const size_t x, const size_t y) const -> Coordinates
+{
+    Coordinates p = min_coord_;
+    p.x() += step_per_pixel_.x() * FromSize(x);
+    p.y() += step_per_pixel_.y() * FromSize(y);
+    return p;
+}
+
+template <CoordinateReal Real>
+void BasicFractalSettings<Real>::RandomizeColors()
+{
+    std::mt19937 rnd(static_cast<unsigned>(color_seed));
+    std::uniform_real_distribution<float> color_distr(0, 1.0f);
+    for (auto& color : colors)
+    {
+        for (float& v : color)
+        {
+            v = color_distr(rnd);
+        }
+    }
+
+    colors_applied = false;
+}
+
+// Instantiated once in fractal_settings.cpp
+extern template struct BasicFractalSettings<Float>;
+
+using FractalSettings = BasicFractalSettings<Float>;
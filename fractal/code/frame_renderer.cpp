@@ -0,0 +1,93 @@
+#include "frame_renderer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <thread>
+
+#include "palette.hpp"
+#include "perturbation.hpp"
+#include "solid_guessing.hpp"
+
+RenderedFrame RenderFrame(FractalCPUWorkerPool& workers, const FractalSettings& settings)
+{
+    const auto start_time = std::chrono::high_resolution_clock::now();
+    const size_t width = settings.GetViewportWidth();
+    const size_t height = settings.GetViewportHeight();
+
+    const Vector2f& step = settings.GetStepPerPixel();
+    PrecisionChoice precision_choice = ChoosePrecision(step.x() > step.y() ? step.x() : step.y());
+    if (!settings.auto_precision)
+    {
+        precision_choice.precision = settings.precision;
+    }
+
+    auto palette = std::make_shared<PaletteLut>();
+    palette->Build(settings.colors, settings.max_iterations);
+
+    std::shared_ptr<PerturbationFrame> perturbation_frame;
+    if (settings.use_perturbation)
+    {
+        const Vector2f& range = settings.GetCoordRange();
+        ReferenceOrbit::Parameters params{
+            .center = settings.GetCamera(),
+            .max_iterations = settings.max_iterations,
+            .max_delta = 0.5 * std::hypot(static_cast<double>(range.x()), static_cast<double>(range.y())),
+            .pixel_size = std::max(static_cast<double>(step.x()), static_cast<double>(step.y())),
+            .use_series_approximation = settings.use_series_approximation,
+            .digits = precision_choice.digits};
+        perturbation_frame = std::make_shared<PerturbationFrame>(params);
+    }
+
+    // Bands of full rows, idle workers split the rows of brute force bands further
+    constexpr size_t kBandHeight = 32;
+    std::vector<std::unique_ptr<ThreadTask>> tasks;
+    for (size_t y = 0; y < height; y += kBandHeight)
+    {
+        auto task = std::make_unique<ThreadTask>();
+        task->iterations = settings.max_iterations;
+        task->precision = precision_choice.precision;
+        task->multiprecision_digits = precision_choice.digits;
+        task->algorithm = settings.render_algorithm;
+        task->solid_guessing = SolidGuessingOptions::FromAggressiveness(
+            settings.solid_guessing_aggressiveness,
+            settings.verify_solid_guessing);
+        task->perturbation = perturbation_frame;
+        task->palette = palette;
+        task->world_start_point = settings.GetCoordAtPixel(0, y);
+        task->world_step_per_pixel = step;
+        task->region_screen_location = {0, y};
+        task->region_screen_size = {width, std::min(kBandHeight, height - y)};
+        workers.Push(task.get());
+        tasks.push_back(std::move(task));
+    }
+
+    // Screen rows go up like in the texture of the app, frame rows go down
+    RenderedFrame frame;
+    frame.precision = precision_choice.precision;
+    frame.iterations.resize(width * height);
+    frame.rgba.resize(width * height);
+    for (const auto& task : tasks)
+    {
+        while (!task->completed)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        frame.stats += task->stats;
+        for (size_t row = 0; row != task->region_screen_size.y(); ++row)
+        {
+            const size_t frame_row = height - 1 - (task->region_screen_location.y() + row);
+            const auto source = static_cast<ptrdiff_t>(row * width);
+            const auto target = static_cast<ptrdiff_t>(frame_row * width);
+            const auto row_size = static_cast<ptrdiff_t>(width);
+            std::copy_n(task->pixels_iterations.begin() + source, row_size, frame.iterations.begin() + target);
+            std::copy_n(task->pixels_rgba.begin() + source, row_size, frame.rgba.begin() + target);
+        }
+    }
+
+    const auto end_time = std::chrono::high_resolution_clock::now();
+    frame.duration_seconds = std::chrono::duration_cast<std::chrono::duration<float>>(end_time - start_time).count();
+    return frame;
+}
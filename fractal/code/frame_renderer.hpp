@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "cpu_worker_pool.hpp"
+#include "fractal_settings.hpp"
+#include "mandelbrot.hpp"
+#include "precision.hpp"
+
+struct RenderedFrame
+{
+    // Row by row from the top row of the viewport
+    std::vector<uint32_t> iterations;
+    std::vector<uint32_t> rgba;
+    FractalPrecision precision = FractalPrecision::Double;
+    MandelbrotStats stats;
+    float duration_seconds = 0.0f;
+};
+
+// Renders the whole viewport of the settings with the CPU engine and waits for it. Precision,
+// algorithm, perturbation and palette follow the settings like in the CPU backend.
+// The workers may be shared by consecutive frames but only one frame is rendered at a time.
+RenderedFrame RenderFrame(FractalCPUWorkerPool& workers, const FractalSettings& settings);
@@ -1,17 +1,29 @@
 #include "fractal_gui.hpp"
 
-#include <random>
+#include <algorithm>
 
-#include "float.hpp"
 #include "imgui.h"
+#include "real_traits.hpp"
 
 void FractalGUI::Draw(float dt)
 {
     {
-        if (ImGui::IsMouseClicked(ImGuiMouseButton_Left) && !ImGui::GetIO().WantCaptureMouse)
+        const auto imgui_cursor = ImGui::GetMousePos();
+        const bool cursor_over_viewport = !ImGui::GetIO().WantCaptureMouse && imgui_cursor.x >= 0 &&
+                                          imgui_cursor.y >= 0 &&
+                                          imgui_cursor.x < static_cast<float>(settings.GetViewportWidth()) &&
+                                          imgui_cursor.y < static_cast<float>(settings.GetViewportHeight());
+        settings.cursor_pixel = std::nullopt;
+        if (cursor_over_viewport)
         {
-            auto imgui_cursor = ImGui::GetMousePos();
-            settings.MoveCameraToPixel(static_cast<size_t>(imgui_cursor.x), static_cast<size_t>(imgui_cursor.y), true);
+            settings.cursor_pixel = Eigen::Vector2<size_t>{
+                static_cast<size_t>(imgui_cursor.x),
+                static_cast<size_t>(imgui_cursor.y)};
+        }
+
+        if (ImGui::IsMouseClicked(ImGuiMouseButton_Left) && cursor_over_viewport)
+        {
+            settings.MoveCameraToPixel(settings.cursor_pixel->x(), settings.cursor_pixel->y(), true);
         }
 
         if (ImGui::IsKeyDown(ImGuiKey_E)) settings.IncrementScale();
@@ -27,11 +39,11 @@ void FractalGUI::Draw(float dt)
     std::string tmp;
     auto float_input = [&](const char* title, const Float& v) -> std::optional<Float>
     {
-        tmp = v.str(std::numeric_limits<double>::digits10 + 3, std::ios_base::fixed);
+        tmp = RealTraits<Float>::ToString(v, std::numeric_limits<double>::digits10 + 3);
         tmp.resize(1000);
         if (ImGui::InputText(title, tmp.data(), 1000))
         {
-            return Float(tmp.c_str());
+            return RealTraits<Float>::FromString(tmp.c_str());
         }
 
         return std::nullopt;
@@ -61,6 +73,24 @@ void FractalGUI::Draw(float dt)
         }
     }
 
+    if (ImGui::CollapsingHeader("Iterations"))
+    {
+        int max_iterations = static_cast<int>(settings.max_iterations);
+        if (ImGui::InputInt("Max iterations", &max_iterations, 100, 10000))
+        {
+            // Color gradient needs at least one iteration per segment
+            max_iterations = std::clamp(
+                max_iterations,
+                static_cast<int>(FractalSettings::colors_count),
+                static_cast<int>(FractalSettings::max_iterations_limit));
+            if (static_cast<uint32_t>(max_iterations) != settings.max_iterations)
+            {
+                settings.max_iterations = static_cast<uint32_t>(max_iterations);
+                settings.settings_applied = false;
+            }
+        }
+    }
+
     if (ImGui::CollapsingHeader("Colors"))
     {
         bool has_changes = false;
@@ -83,21 +113,13 @@ void FractalGUI::Draw(float dt)
         ImGui::SameLine();
         if (ImGui::Button("Randomize"))
         {
-            std::mt19937 rnd(static_cast<unsigned>(settings.color_seed));
-            std::uniform_real_distribution<float> color_distr(0, 1.0f);
-            for (auto& color : settings.colors)
-            {
-                for (float& v : color)
-                {
-                    v = color_distr(rnd);
-                }
-            }
+            settings.RandomizeColors();
             has_changes = true;
         }
 
         if (has_changes)
         {
-            settings.settings_applied = false;
+            settings.colors_applied = false;
         }
     }
 }
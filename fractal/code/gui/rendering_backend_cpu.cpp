@@ -1,9 +1,14 @@
 #include "rendering_backend/rendering_backend_cpu.hpp"
 
+#include <algorithm>
+#include <array>
 #include <string>
 
+#include "cpu_features.hpp"
 #include "fmt/format.h"
 #include "imgui.h"
+#include "interleaved_fill.hpp"
+#include "perturbation.hpp"
 
 void FractalRenderingBackendCPU::DrawSettings()
 {
@@ -14,11 +19,174 @@ void FractalRenderingBackendCPU::DrawSettings()
 
     bool settings_changed = false;
 
-    if (ImGui::Checkbox("Use regualr double", &settings_.use_double))
+    if (ImGui::Checkbox("Automatic precision", &settings_.auto_precision))
     {
         settings_changed = true;
     }
 
+    if (!settings_.auto_precision)
+    {
+        std::array<const char*, kFractalPrecisionCount> precision_names{};
+        for (size_t index = 0; index != precision_names.size(); ++index)
+        {
+            precision_names[index] = ToString(static_cast<FractalPrecision>(index)).data();
+        }
+
+        int precision = static_cast<int>(settings_.precision);
+        if (ImGui::Combo("Precision", &precision, precision_names.data(), static_cast<int>(precision_names.size())))
+        {
+            settings_.precision = static_cast<FractalPrecision>(precision);
+            settings_changed = true;
+        }
+    }
+
+    {
+        const PrecisionChoice& choice = precision_choice_;
+        if (choice.precision == FractalPrecision::Multiprecision)
+        {
+            ImGui::Text("Precision: %s<%u>", ToString(choice.precision).data(), choice.digits);
+        }
+        else
+        {
+            ImGui::Text("Precision: %s", ToString(choice.precision).data());
+        }
+
+        const unsigned bits = GetPrecisionBits(choice.precision, choice.digits);
+        ImGui::Text(
+            "Pixel size 2^%d needs %u bits, %s has %u",
+            choice.pixel_exponent,
+            choice.required_bits,
+            ToString(choice.precision).data(),
+            bits);
+        if (bits < choice.required_bits)
+        {
+            ImGui::Text("Not enough precision for this zoom");
+        }
+    }
+
+    ImGui::Text("SIMD: %s", ToString(GetSimdIsa()).data());
+    ImGui::Text("Worker threads: %zu", workers_.GetThreadsCount());
+
+    {
+        std::array<const char*, kFractalRenderAlgorithmCount> algorithm_names{};
+        for (size_t index = 0; index != algorithm_names.size(); ++index)
+        {
+            algorithm_names[index] = ToString(static_cast<FractalRenderAlgorithm>(index)).data();
+        }
+
+        int algorithm = static_cast<int>(settings_.render_algorithm);
+        if (ImGui::Combo("Algorithm", &algorithm, algorithm_names.data(), static_cast<int>(algorithm_names.size())))
+        {
+            settings_.render_algorithm = static_cast<FractalRenderAlgorithm>(algorithm);
+            settings_changed = true;
+        }
+
+        if (settings_.render_algorithm == FractalRenderAlgorithm::SolidGuessing)
+        {
+            if (ImGui::SliderInt(
+                    "Guess aggressiveness",
+                    &settings_.solid_guessing_aggressiveness,
+                    0,
+                    SolidGuessingOptions::kMaxAggressiveness))
+            {
+                settings_changed = true;
+            }
+
+            if (ImGui::Checkbox("Verify guesses", &settings_.verify_solid_guessing))
+            {
+                settings_changed = true;
+            }
+        }
+    }
+
+    {
+        const MandelbrotStats& stats = GetPreviousFrameStats();
+        ImGui::Text("Skipped by cardioid/bulb: %zu iterations", stats.cardioid_skipped);
+        ImGui::Text("Skipped by periodicity: %zu iterations", stats.periodicity_skipped);
+
+        const size_t pixels_total = stats.pixels_computed + stats.pixels_filled;
+        if (pixels_total != 0)
+        {
+            const float filled_fraction = static_cast<float>(stats.pixels_filled) / static_cast<float>(pixels_total);
+            ImGui::Text("Pixels filled without iterating: %.1f%%", static_cast<double>(100.0f * filled_fraction));
+        }
+
+        if (settings_.render_algorithm == FractalRenderAlgorithm::SolidGuessing && settings_.verify_solid_guessing)
+        {
+            ImGui::Text("Wrong guesses: %zu pixels", stats.wrong_guesses);
+        }
+    }
+
+    if (ImGui::Checkbox("Use perturbation (deep zoom)", &settings_.use_perturbation))
+    {
+        settings_changed = true;
+    }
+
+    if (settings_.use_perturbation)
+    {
+        if (ImGui::Checkbox("Series approximation", &settings_.use_series_approximation))
+        {
+            settings_changed = true;
+        }
+
+        if (const ReferenceOrbit* orbit = perturbation_frame_ ? perturbation_frame_->TryGetOrbit() : nullptr)
+        {
+            ImGui::Text("Reference orbit: %zu iterations", orbit->GetLength());
+            ImGui::Text("Skipped by series: %zu iterations", orbit->GetSeriesSkip());
+        }
+    }
+
+    if (ImGui::Checkbox("Tile cache", &settings_.use_tile_cache))
+    {
+        settings_changed = true;
+    }
+
+    if (settings_.use_tile_cache)
+    {
+        if (ImGui::InputInt("Tile cache budget (MiB)", &settings_.tile_cache_budget_mb))
+        {
+            settings_.tile_cache_budget_mb = std::max(settings_.tile_cache_budget_mb, 0);
+            tile_cache_.SetByteBudget(static_cast<size_t>(settings_.tile_cache_budget_mb) << 20);
+        }
+
+        const TileCache::Stats& stats = tile_cache_.GetStats();
+        ImGui::Text(
+            "Tiles: %zu, %.1f MiB",
+            tile_cache_.GetTilesCount(),
+            static_cast<double>(tile_cache_.GetBytes()) / (1024.0 * 1024.0));
+        ImGui::Text("Hits: %zu, misses: %zu, evictions: %zu", stats.hits, stats.misses, stats.evictions);
+
+        if (ImGui::Checkbox("Persist tiles on disk", &settings_.persist_tiles))
+        {
+            settings_changed = true;
+        }
+
+        if (tile_store_)
+        {
+            const TileStore::Stats& store_stats = tile_store_->GetStats();
+            ImGui::Text(
+                "Stored tiles: %zu in %s",
+                tile_store_->GetTilesCount(),
+                tile_store_->GetDirectory().string().c_str());
+            ImGui::Text(
+                "Store hits: %zu, misses: %zu, appends: %zu",
+                store_stats.hits,
+                store_stats.misses,
+                store_stats.appends);
+        }
+
+        if (ImGui::Checkbox("Speculative tiles when idle", &settings_.speculative_tiles))
+        {
+            settings_changed = true;
+        }
+
+        ImGui::Text("Speculative tiles computed: %zu", speculative_tiles_computed_);
+        if (settings_.use_perturbation)
+        {
+            ImGui::Text("Not used with perturbation");
+        }
+    }
+
     auto opt_prev_frame_duration = TakePreviousFrameDuration();
     if (opt_prev_frame_duration.has_value())
     {
@@ -43,8 +211,24 @@ void FractalRenderingBackendCPU::DrawSettings()
         ForEachTask(
             [](const ThreadTask& task)
             {
-                const size_t completed = task.rows_completed;
-                const size_t total = task.region_screen_size.y();
+                if (task.speculative)
+                {
+                    return;
+                }
+
+                size_t completed = task.rows_completed;
+                size_t total = task.region_screen_size.y();
+                if (task.algorithm == FractalRenderAlgorithm::Interleaved)
+                {
+                    completed = task.passes_completed;
+                    total = kInterleavedPasses.size();
+                }
+                else if (task.algorithm == FractalRenderAlgorithm::SolidGuessing)
+                {
+                    completed = task.passes_completed;
+                    total = task.solid_guessing.GetPassesCount();
+                }
+
                 const float progress = static_cast<float>(completed) / static_cast<float>(total);
                 ImGui::ProgressBar(progress);
             });
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "iteration_grid.hpp"
+
+// Pixels of one Adam7 pass within every 8x8 block: offset and step on both axes
+struct InterleavedPass
+{
+    size_t x0;
+    size_t y0;
+    size_t dx;
+    size_t dy;
+};
+
+inline constexpr std::array<InterleavedPass, 7> kInterleavedPasses{{
+    {0, 0, 8, 8},
+    {4, 0, 8, 8},
+    {0, 4, 4, 8},
+    {2, 0, 4, 4},
+    {0, 2, 2, 4},
+    {1, 0, 2, 2},
+    {0, 1, 1, 2},
+}};
+
+// After passes_completed passes every pixel with x % step.x == 0 and y % step.y == 0 is known
+// so a preview repeats it over the step.x by step.y block.
+inline PixelIndex GetInterleavedPreviewStep(size_t passes_completed)
+{
+    constexpr std::array<PixelIndex, 8> kSteps{{{8, 8}, {8, 8}, {4, 8}, {4, 4}, {2, 4}, {2, 2}, {1, 2}, {1, 1}}};
+    return kSteps[passes_completed < kSteps.size() ? passes_completed : kSteps.size() - 1];
+}
+
+// Iterates every pixel in Adam7 order so that a partially computed region already covers the
+// whole region at a coarse resolution. The amount of work is the same as for brute force.
+// passes_completed is released after each pass: pixels of completed passes may be read by
+// another thread while the next pass is computed.
+// Evaluator::ComputePixels(std::span<const PixelIndex>) iterates the given pixels into the grid.
+template <typename Evaluator>
+class InterleavedFill
+{
+public:
+    InterleavedFill(IterationGrid grid, Evaluator& evaluator, std::atomic<uint8_t>& passes_completed)
+        : grid_(grid),
+          evaluator_(evaluator),
+          passes_completed_(passes_completed)
+    {
+    }
+
+    void Run()
+    {
+        for (size_t pass_index = 0; pass_index != kInterleavedPasses.size(); ++pass_index)
+        {
+            const InterleavedPass& pass = kInterleavedPasses[pass_index];
+            batch_.clear();
+            for (size_t y = pass.y0; y < grid_.height; y += pass.dy)
+            {
+                for (size_t x = pass.x0; x < grid_.width; x += pass.dx)
+                {
+                    batch_.push_back({x, y});
+                }
+            }
+
+            if (!batch_.empty())
+            {
+                evaluator_.ComputePixels(batch_);
+            }
+
+            passes_completed_.store(static_cast<uint8_t>(pass_index + 1), std::memory_order_release);
+        }
+    }
+
+private:
+    IterationGrid grid_;
+    Evaluator& evaluator_;
+    std::atomic<uint8_t>& passes_completed_;
+    std::vector<PixelIndex> batch_;
+};
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// Location of a pixel in a task region
+struct PixelIndex
+{
+    size_t x = 0;
+    size_t y = 0;
+};
+
+// Iteration counts of a task region in row-major order
+struct IterationGrid
+{
+    uint32_t& At(size_t x, size_t y) const
+    {
+        return pixels[y * width + x];
+    }
+
+    std::span<uint32_t> pixels;
+    size_t width = 0;
+    size_t height = 0;
+};
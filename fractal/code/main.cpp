@@ -3,14 +3,12 @@
 #include <filesystem>
 #include <map>
 #include <optional>
-#include <random>
 #include <string_view>
 #include <thread>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
-#include "boost/multiprecision/cpp_dec_float.hpp"
 #include "float.hpp"
 #include "fmt/format.h"
 #include "fractal_settings.hpp"
@@ -36,7 +34,6 @@ public:
     using Super = klgl::Application;
 
     void DrawSettings(const float dt);
-    void RandomizeColors();
 
     void Initialize() override;
     void Tick(float dt) override;
@@ -45,6 +42,8 @@ public:
 private:
     bool render_on_cpu = false;
     FractalSettings settings;
+    // Created with the first CPU backend and kept when switching backends
+    std::unique_ptr<FractalCPUWorkerPool> cpu_workers_;
     std::unique_ptr<FractalRenderingBackend> rendering_backend_;
 };
 
@@ -58,7 +57,7 @@ void FractalApp::Initialize()
     const auto content_dir = GetExecutableDir() / "content";
     const auto shaders_dir = content_dir / "shaders";
     klgl::Shader::shaders_dir_ = shaders_dir;
-    RandomizeColors();
+    settings.RandomizeColors();
 }
 
 void FractalApp::Tick(float delta_time)
@@ -93,9 +92,16 @@ void FractalApp::DrawSettings(const float dt)
 
     if (!rendering_backend_ || ImGui::Checkbox("Render on cpu", &render_on_cpu))
     {
+        // The previous backend waits for its tasks before the next one is created
+        rendering_backend_ = nullptr;
         if (render_on_cpu)
         {
-            rendering_backend_ = std::make_unique<FractalRenderingBackendCPU>(*this, settings);
+            if (!cpu_workers_)
+            {
+                cpu_workers_ = std::make_unique<FractalCPUWorkerPool>();
+            }
+
+            rendering_backend_ = std::make_unique<FractalRenderingBackendCPU>(*this, settings, *cpu_workers_);
         }
         else
         {
@@ -116,19 +122,6 @@ void FractalApp::DrawSettings(const float dt)
     ImGui::End();
 }
 
-void FractalApp::RandomizeColors()
-{
-    std::mt19937 rnd(static_cast<unsigned>(settings.color_seed));
-    std::uniform_real_distribution<float> color_distr(0, 1.0f);
-    for (auto& color : settings.colors)
-    {
-        for (float& v : color)
-        {
-            v = color_distr(rnd);
-        }
-    }
-}
-
 int main()
 {
     setenv("GALLIUM_DRIVER", "llvmpipe", 1);
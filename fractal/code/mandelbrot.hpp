@@ -2,25 +2,104 @@
 
 #include <cstddef>
 
+// Work that was not done thanks to interior checks and fill algorithms
+struct MandelbrotStats
+{
+    // Iterations
+    size_t cardioid_skipped = 0;
+    size_t periodicity_skipped = 0;
+
+    // Pixels
+    size_t pixels_computed = 0;
+    size_t pixels_filled = 0;
+    // Guessed pixels that differ from iterated ones (solid guessing verification)
+    size_t wrong_guesses = 0;
+
+    MandelbrotStats& operator+=(const MandelbrotStats& other)
+    {
+        cardioid_skipped += other.cardioid_skipped;
+        periodicity_skipped += other.periodicity_skipped;
+        pixels_computed += other.pixels_computed;
+        pixels_filled += other.pixels_filled;
+        wrong_guesses += other.wrong_guesses;
+        return *this;
+    }
+};
+
+// Equality without operator== which is noisy for floating point types
 template <typename T>
-inline size_t MandelbrotLoop(const T& x0, const T& y0, size_t max_iterations)
+inline bool IsSameValue(const T& a, const T& b)
 {
+    return !(a < b) && !(b < a);
+}
+
+// Analytic test for the main cardioid and the period-2 bulb. Points inside never escape.
+template <typename T>
+inline bool IsInMainCardioidOrBulb(const T& x0, const T& y0)
+{
+    const T y2 = y0 * y0;
+    const T shifted_x = x0 - T(0.25);
+    const T q = shifted_x * shifted_x + y2;
+    if (q * (q + shifted_x) <= y2 * T(0.25))
+    {
+        return true;
+    }
+
+    const T bulb_x = x0 + T(1);
+    return bulb_x * bulb_x + y2 <= T(0.0625);
+}
+
+template <typename T>
+inline size_t MandelbrotLoop(const T& x0, const T& y0, size_t max_iterations, MandelbrotStats& stats)
+{
+    if (IsInMainCardioidOrBulb(x0, y0))
+    {
+        stats.cardioid_skipped += max_iterations;
+        return max_iterations;
+    }
+
     T x2{0};
     T y2{0};
     T w{0};
     size_t iteration = 0;
 
+    // Brent's cycle detection: the orbit is compared with a point saved at power of two iterations.
+    // Exact repetition means the orbit is periodic and will never escape.
+    T saved_x{0};
+    T saved_y{0};
+    size_t checkpoint = 1;
+
     while (x2 + y2 <= 4 && iteration != max_iterations)
     {
-        auto x = x2 - y2 + x0;
-        auto y = w - x2 - y2 + y0;
+        T x = x2 - y2 + x0;
+        T y = w - x2 - y2 + y0;
         x2 = x * x;
         y2 = y * y;
         w = x + y;
         w *= w;
 
         ++iteration;
+
+        if (IsSameValue(x, saved_x) && IsSameValue(y, saved_y))
+        {
+            stats.periodicity_skipped += max_iterations - iteration;
+            return max_iterations;
+        }
+
+        if (iteration == checkpoint)
+        {
+            saved_x = x;
+            saved_y = y;
+            checkpoint *= 2;
+        }
     }
 
     return iteration;
 }
+
+template <typename T>
+inline size_t MandelbrotLoop(const T& x0, const T& y0, size_t max_iterations)
+{
+    MandelbrotStats stats;
+    return MandelbrotLoop(x0, y0, max_iterations, stats);
+}
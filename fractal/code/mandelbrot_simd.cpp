@@ -0,0 +1,999 @@
+#include "mandelbrot_simd.hpp"
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cassert>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "cpu_features.hpp"
+#include "mandelbrot.hpp"
+
+#if FRACTAL_X86_SIMD
+#include <immintrin.h>
+
+// GCC contracts the intrinsics into FMA under AVX-512 which changes rounding
+#if defined(__clang__)
+#define FRACTAL_SIMD_TARGET(isa) [[gnu::target(isa)]]
+#else
+#define FRACTAL_SIMD_TARGET(isa) [[gnu::target(isa), gnu::optimize("fp-contract=off")]]
+#endif
+#endif
+
+namespace
+{
+
+inline std::array<float, 1> ToLimbs(float value)
+{
+    return {value};
+}
+
+inline std::array<double, 1> ToLimbs(double value)
+{
+    return {value};
+}
+
+inline std::array<double, 2> ToLimbs(const DoubleDouble& value)
+{
+    return {value.hi, value.lo};
+}
+
+inline std::array<double, 4> ToLimbs(const QuadDouble& value)
+{
+    return value.limbs;
+}
+
+// x0 + dx * index computed the same way by scalar and vector kernels
+template <typename T>
+T PixelCoordinate(const T& x0, const T& dx, size_t index)
+{
+    if constexpr (std::is_same_v<T, float>)
+    {
+        return x0 + dx * static_cast<float>(index);
+    }
+    else
+    {
+        return x0 + dx * static_cast<double>(index);
+    }
+}
+
+enum class RunShape : uint8_t
+{
+    Row,
+    Column,
+    Scattered
+};
+
+// Pixels computed by one kernel call, out[i] receives pixel i of the run.
+// Grid pixel (i, j) is located at (x0 + dx * i, y0 + dy * j): a row uses y0 as is and only
+// steps along x starting from first_pixel, a column does the opposite.
+template <typename T>
+struct PixelRun
+{
+    void GetPixel(size_t index, T& x, T& y) const
+    {
+        switch (shape)
+        {
+        case RunShape::Row:
+            x = PixelCoordinate(x0, dx, first_pixel + index);
+            y = y0;
+            break;
+        case RunShape::Column:
+            x = x0;
+            y = PixelCoordinate(y0, dy, first_pixel + index);
+            break;
+        case RunShape::Scattered:
+            x = PixelCoordinate(x0, dx, pixels[index].x);
+            y = PixelCoordinate(y0, dy, pixels[index].y);
+            break;
+        }
+    }
+
+    T x0;
+    T y0;
+    T dx;
+    T dy;
+    RunShape shape = RunShape::Row;
+    size_t first_pixel = 0;
+    std::span<const PixelIndex> pixels;
+    size_t max_iterations = 0;
+    std::span<uint32_t> out;
+    MandelbrotStats& stats;
+};
+
+// Per-lane state of the run kernel. Vector code loads it into registers, iterates until
+// some lane finishes and stores it back so that finished lanes can be refilled here.
+// Multi-precision values are stored limb by limb: cx[limb][lane].
+template <typename T, size_t kLanes>
+struct RunLanes
+{
+    using LimbsArray = decltype(ToLimbs(std::declval<T>()));
+    using Limb = typename LimbsArray::value_type;
+    static constexpr size_t kLimbs = std::tuple_size_v<LimbsArray>;
+    using Limbs = std::array<std::array<Limb, kLanes>, kLimbs>;
+
+    explicit RunLanes(const PixelRun<T>& in_run)
+        : run(in_run),
+          max_iterations_limb(static_cast<Limb>(in_run.max_iterations))
+    {
+        // Iteration counters are kept in Limb: float counts exactly up to 2^24
+        assert(run.max_iterations <= (size_t{1} << std::numeric_limits<Limb>::digits));
+
+        for (size_t lane = 0; lane != kLanes; ++lane)
+        {
+            Load(lane);
+        }
+    }
+
+    // Pixels inside the main cardioid or the period-2 bulb are written immediately and skipped
+    void Load(size_t lane)
+    {
+        const uint32_t lane_bit = 1u << lane;
+        for (; next_pixel != run.out.size(); ++next_pixel)
+        {
+            T pixel_x{};
+            T pixel_y{};
+            run.GetPixel(next_pixel, pixel_x, pixel_y);
+            if (IsInMainCardioidOrBulb(pixel_x, pixel_y))
+            {
+                run.out[next_pixel] = static_cast<uint32_t>(run.max_iterations);
+                run.stats.cardioid_skipped += run.max_iterations;
+                continue;
+            }
+
+            const auto cx_limbs = ToLimbs(pixel_x);
+            const auto cy_limbs = ToLimbs(pixel_y);
+            for (size_t limb = 0; limb != kLimbs; ++limb)
+            {
+                cx[limb][lane] = cx_limbs[limb];
+                cy[limb][lane] = cy_limbs[limb];
+                x2[limb][lane] = 0;
+                y2[limb][lane] = 0;
+                w[limb][lane] = 0;
+                saved_x[limb][lane] = 0;
+                saved_y[limb][lane] = 0;
+            }
+
+            pixel[lane] = next_pixel;
+            iteration[lane] = 0;
+            checkpoint[lane] = 1;
+            live_mask |= lane_bit;
+            ++next_pixel;
+            return;
+        }
+
+        live_mask &= ~lane_bit;
+    }
+
+    // Writes results of finished lanes and loads the next pixels into them.
+    // Periodic lanes are interior points detected by the cycle check.
+    void Refill(uint32_t finished_mask, uint32_t periodic_mask)
+    {
+        while (finished_mask)
+        {
+            const auto lane = static_cast<size_t>(std::countr_zero(finished_mask));
+            const uint32_t lane_bit = 1u << lane;
+            finished_mask &= finished_mask - 1;
+
+            auto result = static_cast<size_t>(iteration[lane]);
+            if (periodic_mask & lane_bit)
+            {
+                run.stats.periodicity_skipped += run.max_iterations - result;
+                result = run.max_iterations;
+            }
+
+            run.out[pixel[lane]] = static_cast<uint32_t>(result);
+            Load(lane);
+        }
+    }
+
+    alignas(64) Limbs cx{};
+    alignas(64) Limbs cy{};
+    alignas(64) Limbs x2{};
+    alignas(64) Limbs y2{};
+    alignas(64) Limbs w{};
+    alignas(64) std::array<Limb, kLanes> iteration{};
+    // Brent's cycle detection state, same as in MandelbrotLoop
+    alignas(64) Limbs saved_x{};
+    alignas(64) Limbs saved_y{};
+    alignas(64) std::array<Limb, kLanes> checkpoint{};
+    std::array<size_t, kLanes> pixel{};
+    uint32_t live_mask = 0;
+    size_t next_pixel = 0;
+    const PixelRun<T>& run;
+    Limb max_iterations_limb;
+};
+
+template <typename T>
+void MandelbrotRunScalar(const PixelRun<T>& run)
+{
+    for (size_t index = 0; index != run.out.size(); ++index)
+    {
+        T x{};
+        T y{};
+        run.GetPixel(index, x, y);
+        run.out[index] = static_cast<uint32_t>(MandelbrotLoop<T>(x, y, run.max_iterations, run.stats));
+    }
+}
+
+#if FRACTAL_X86_SIMD
+
+// The arithmetic mirrors MandelbrotLoop<double> operation by operation (no FMA)
+// so that SIMD and scalar paths produce identical images.
+FRACTAL_SIMD_TARGET("avx2") void MandelbrotRunAVX2(const PixelRun<double>& run)
+{
+    RunLanes<double, 4> lanes(run);
+
+    const __m256d four = _mm256_set1_pd(4.0);
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d max_iter = _mm256_set1_pd(lanes.max_iterations_limb);
+
+    while (lanes.live_mask)
+    {
+        const __m256d cx = _mm256_load_pd(lanes.cx[0].data());
+        const __m256d cy = _mm256_load_pd(lanes.cy[0].data());
+        __m256d x2 = _mm256_load_pd(lanes.x2[0].data());
+        __m256d y2 = _mm256_load_pd(lanes.y2[0].data());
+        __m256d w = _mm256_load_pd(lanes.w[0].data());
+        __m256d iteration = _mm256_load_pd(lanes.iteration.data());
+        __m256d saved_x = _mm256_load_pd(lanes.saved_x[0].data());
+        __m256d saved_y = _mm256_load_pd(lanes.saved_y[0].data());
+        __m256d checkpoint = _mm256_load_pd(lanes.checkpoint.data());
+        __m256d periodic = _mm256_setzero_pd();
+
+        uint32_t finished = 0;
+        while (true)
+        {
+            const __m256d in_radius = _mm256_cmp_pd(_mm256_add_pd(x2, y2), four, _CMP_LE_OQ);
+            const __m256d below_max = _mm256_cmp_pd(iteration, max_iter, _CMP_NEQ_OQ);
+            const __m256d running = _mm256_andnot_pd(periodic, _mm256_and_pd(in_radius, below_max));
+            const auto active = static_cast<uint32_t>(_mm256_movemask_pd(running));
+            finished = ~active & lanes.live_mask;
+            if (finished)
+            {
+                break;
+            }
+
+            const __m256d x = _mm256_add_pd(_mm256_sub_pd(x2, y2), cx);
+            const __m256d y = _mm256_add_pd(_mm256_sub_pd(_mm256_sub_pd(w, x2), y2), cy);
+            x2 = _mm256_mul_pd(x, x);
+            y2 = _mm256_mul_pd(y, y);
+            const __m256d s = _mm256_add_pd(x, y);
+            w = _mm256_mul_pd(s, s);
+            iteration = _mm256_add_pd(iteration, one);
+
+            periodic = _mm256_and_pd(_mm256_cmp_pd(x, saved_x, _CMP_EQ_OQ), _mm256_cmp_pd(y, saved_y, _CMP_EQ_OQ));
+            const __m256d at_checkpoint = _mm256_cmp_pd(iteration, checkpoint, _CMP_EQ_OQ);
+            if (!_mm256_testz_pd(at_checkpoint, at_checkpoint))
+            {
+                saved_x = _mm256_blendv_pd(saved_x, x, at_checkpoint);
+                saved_y = _mm256_blendv_pd(saved_y, y, at_checkpoint);
+                checkpoint = _mm256_blendv_pd(checkpoint, _mm256_add_pd(checkpoint, checkpoint), at_checkpoint);
+            }
+        }
+
+        _mm256_store_pd(lanes.x2[0].data(), x2);
+        _mm256_store_pd(lanes.y2[0].data(), y2);
+        _mm256_store_pd(lanes.w[0].data(), w);
+        _mm256_store_pd(lanes.iteration.data(), iteration);
+        _mm256_store_pd(lanes.saved_x[0].data(), saved_x);
+        _mm256_store_pd(lanes.saved_y[0].data(), saved_y);
+        _mm256_store_pd(lanes.checkpoint.data(), checkpoint);
+        lanes.Refill(finished, static_cast<uint32_t>(_mm256_movemask_pd(periodic)));
+    }
+}
+
+FRACTAL_SIMD_TARGET("avx512f") void MandelbrotRunAVX512(const PixelRun<double>& run)
+{
+    RunLanes<double, 8> lanes(run);
+
+    const __m512d four = _mm512_set1_pd(4.0);
+    const __m512d one = _mm512_set1_pd(1.0);
+    const __m512d max_iter = _mm512_set1_pd(lanes.max_iterations_limb);
+
+    while (lanes.live_mask)
+    {
+        const __m512d cx = _mm512_load_pd(lanes.cx[0].data());
+        const __m512d cy = _mm512_load_pd(lanes.cy[0].data());
+        __m512d x2 = _mm512_load_pd(lanes.x2[0].data());
+        __m512d y2 = _mm512_load_pd(lanes.y2[0].data());
+        __m512d w = _mm512_load_pd(lanes.w[0].data());
+        __m512d iteration = _mm512_load_pd(lanes.iteration.data());
+        __m512d saved_x = _mm512_load_pd(lanes.saved_x[0].data());
+        __m512d saved_y = _mm512_load_pd(lanes.saved_y[0].data());
+        __m512d checkpoint = _mm512_load_pd(lanes.checkpoint.data());
+        __mmask8 periodic = 0;
+
+        uint32_t finished = 0;
+        while (true)
+        {
+            const __mmask8 in_radius = _mm512_cmp_pd_mask(_mm512_add_pd(x2, y2), four, _CMP_LE_OQ);
+            const __mmask8 active = _mm512_mask_cmp_pd_mask(in_radius & ~periodic, iteration, max_iter, _CMP_NEQ_OQ);
+            finished = ~static_cast<uint32_t>(active) & lanes.live_mask;
+            if (finished)
+            {
+                break;
+            }
+
+            const __m512d x = _mm512_add_pd(_mm512_sub_pd(x2, y2), cx);
+            const __m512d y = _mm512_add_pd(_mm512_sub_pd(_mm512_sub_pd(w, x2), y2), cy);
+            x2 = _mm512_mul_pd(x, x);
+            y2 = _mm512_mul_pd(y, y);
+            const __m512d s = _mm512_add_pd(x, y);
+            w = _mm512_mul_pd(s, s);
+            iteration = _mm512_add_pd(iteration, one);
+
+            periodic = _mm512_cmp_pd_mask(x, saved_x, _CMP_EQ_OQ) & _mm512_cmp_pd_mask(y, saved_y, _CMP_EQ_OQ);
+            const __mmask8 at_checkpoint = _mm512_cmp_pd_mask(iteration, checkpoint, _CMP_EQ_OQ);
+            if (at_checkpoint)
+            {
+                saved_x = _mm512_mask_mov_pd(saved_x, at_checkpoint, x);
+                saved_y = _mm512_mask_mov_pd(saved_y, at_checkpoint, y);
+                checkpoint = _mm512_mask_add_pd(checkpoint, at_checkpoint, checkpoint, checkpoint);
+            }
+        }
+
+        _mm512_store_pd(lanes.x2[0].data(), x2);
+        _mm512_store_pd(lanes.y2[0].data(), y2);
+        _mm512_store_pd(lanes.w[0].data(), w);
+        _mm512_store_pd(lanes.iteration.data(), iteration);
+        _mm512_store_pd(lanes.saved_x[0].data(), saved_x);
+        _mm512_store_pd(lanes.saved_y[0].data(), saved_y);
+        _mm512_store_pd(lanes.checkpoint.data(), checkpoint);
+        lanes.Refill(finished, periodic);
+    }
+}
+
+// Same kernels for float with twice as many lanes
+FRACTAL_SIMD_TARGET("avx2") void MandelbrotRunSingleAVX2(const PixelRun<float>& run)
+{
+    RunLanes<float, 8> lanes(run);
+
+    const __m256 four = _mm256_set1_ps(4.0f);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 max_iter = _mm256_set1_ps(lanes.max_iterations_limb);
+
+    while (lanes.live_mask)
+    {
+        const __m256 cx = _mm256_load_ps(lanes.cx[0].data());
+        const __m256 cy = _mm256_load_ps(lanes.cy[0].data());
+        __m256 x2 = _mm256_load_ps(lanes.x2[0].data());
+        __m256 y2 = _mm256_load_ps(lanes.y2[0].data());
+        __m256 w = _mm256_load_ps(lanes.w[0].data());
+        __m256 iteration = _mm256_load_ps(lanes.iteration.data());
+        __m256 saved_x = _mm256_load_ps(lanes.saved_x[0].data());
+        __m256 saved_y = _mm256_load_ps(lanes.saved_y[0].data());
+        __m256 checkpoint = _mm256_load_ps(lanes.checkpoint.data());
+        __m256 periodic = _mm256_setzero_ps();
+
+        uint32_t finished = 0;
+        while (true)
+        {
+            const __m256 in_radius = _mm256_cmp_ps(_mm256_add_ps(x2, y2), four, _CMP_LE_OQ);
+            const __m256 below_max = _mm256_cmp_ps(iteration, max_iter, _CMP_NEQ_OQ);
+            const __m256 running = _mm256_andnot_ps(periodic, _mm256_and_ps(in_radius, below_max));
+            const auto active = static_cast<uint32_t>(_mm256_movemask_ps(running));
+            finished = ~active & lanes.live_mask;
+            if (finished)
+            {
+                break;
+            }
+
+            const __m256 x = _mm256_add_ps(_mm256_sub_ps(x2, y2), cx);
+            const __m256 y = _mm256_add_ps(_mm256_sub_ps(_mm256_sub_ps(w, x2), y2), cy);
+            x2 = _mm256_mul_ps(x, x);
+            y2 = _mm256_mul_ps(y, y);
+            const __m256 s = _mm256_add_ps(x, y);
+            w = _mm256_mul_ps(s, s);
+            iteration = _mm256_add_ps(iteration, one);
+
+            periodic = _mm256_and_ps(_mm256_cmp_ps(x, saved_x, _CMP_EQ_OQ), _mm256_cmp_ps(y, saved_y, _CMP_EQ_OQ));
+            const __m256 at_checkpoint = _mm256_cmp_ps(iteration, checkpoint, _CMP_EQ_OQ);
+            if (!_mm256_testz_ps(at_checkpoint, at_checkpoint))
+            {
+                saved_x = _mm256_blendv_ps(saved_x, x, at_checkpoint);
+                saved_y = _mm256_blendv_ps(saved_y, y, at_checkpoint);
+                checkpoint = _mm256_blendv_ps(checkpoint, _mm256_add_ps(checkpoint, checkpoint), at_checkpoint);
+            }
+        }
+
+        _mm256_store_ps(lanes.x2[0].data(), x2);
+        _mm256_store_ps(lanes.y2[0].data(), y2);
+        _mm256_store_ps(lanes.w[0].data(), w);
+        _mm256_store_ps(lanes.iteration.data(), iteration);
+        _mm256_store_ps(lanes.saved_x[0].data(), saved_x);
+        _mm256_store_ps(lanes.saved_y[0].data(), saved_y);
+        _mm256_store_ps(lanes.checkpoint.data(), checkpoint);
+        lanes.Refill(finished, static_cast<uint32_t>(_mm256_movemask_ps(periodic)));
+    }
+}
+
+FRACTAL_SIMD_TARGET("avx512f") void MandelbrotRunSingleAVX512(const PixelRun<float>& run)
+{
+    RunLanes<float, 16> lanes(run);
+
+    const __m512 four = _mm512_set1_ps(4.0f);
+    const __m512 one = _mm512_set1_ps(1.0f);
+    const __m512 max_iter = _mm512_set1_ps(lanes.max_iterations_limb);
+
+    while (lanes.live_mask)
+    {
+        const __m512 cx = _mm512_load_ps(lanes.cx[0].data());
+        const __m512 cy = _mm512_load_ps(lanes.cy[0].data());
+        __m512 x2 = _mm512_load_ps(lanes.x2[0].data());
+        __m512 y2 = _mm512_load_ps(lanes.y2[0].data());
+        __m512 w = _mm512_load_ps(lanes.w[0].data());
+        __m512 iteration = _mm512_load_ps(lanes.iteration.data());
+        __m512 saved_x = _mm512_load_ps(lanes.saved_x[0].data());
+        __m512 saved_y = _mm512_load_ps(lanes.saved_y[0].data());
+        __m512 checkpoint = _mm512_load_ps(lanes.checkpoint.data());
+        __mmask16 periodic = 0;
+
+        uint32_t finished = 0;
+        while (true)
+        {
+            const __mmask16 in_radius = _mm512_cmp_ps_mask(_mm512_add_ps(x2, y2), four, _CMP_LE_OQ);
+            const __mmask16 active = _mm512_mask_cmp_ps_mask(in_radius & ~periodic, iteration, max_iter, _CMP_NEQ_OQ);
+            finished = ~static_cast<uint32_t>(active) & lanes.live_mask;
+            if (finished)
+            {
+                break;
+            }
+
+            const __m512 x = _mm512_add_ps(_mm512_sub_ps(x2, y2), cx);
+            const __m512 y = _mm512_add_ps(_mm512_sub_ps(_mm512_sub_ps(w, x2), y2), cy);
+            x2 = _mm512_mul_ps(x, x);
+            y2 = _mm512_mul_ps(y, y);
+            const __m512 s = _mm512_add_ps(x, y);
+            w = _mm512_mul_ps(s, s);
+            iteration = _mm512_add_ps(iteration, one);
+
+            periodic = _mm512_cmp_ps_mask(x, saved_x, _CMP_EQ_OQ) & _mm512_cmp_ps_mask(y, saved_y, _CMP_EQ_OQ);
+            const __mmask16 at_checkpoint = _mm512_cmp_ps_mask(iteration, checkpoint, _CMP_EQ_OQ);
+            if (at_checkpoint)
+            {
+                saved_x = _mm512_mask_mov_ps(saved_x, at_checkpoint, x);
+                saved_y = _mm512_mask_mov_ps(saved_y, at_checkpoint, y);
+                checkpoint = _mm512_mask_add_ps(checkpoint, at_checkpoint, checkpoint, checkpoint);
+            }
+        }
+
+        _mm512_store_ps(lanes.x2[0].data(), x2);
+        _mm512_store_ps(lanes.y2[0].data(), y2);
+        _mm512_store_ps(lanes.w[0].data(), w);
+        _mm512_store_ps(lanes.iteration.data(), iteration);
+        _mm512_store_ps(lanes.saved_x[0].data(), saved_x);
+        _mm512_store_ps(lanes.saved_y[0].data(), saved_y);
+        _mm512_store_ps(lanes.checkpoint.data(), checkpoint);
+        lanes.Refill(finished, periodic);
+    }
+}
+
+// Multi-precision kernels mirror DoubleDouble and QuadDouble operation by operation.
+// Products use FMA instead of Dekker's split: both give the exact rounding error.
+#define FRACTAL_MP_TARGET FRACTAL_SIMD_TARGET("avx2,fma")
+
+FRACTAL_MP_TARGET inline __m256d QuickTwoSum(__m256d a, __m256d b, __m256d& error)
+{
+    const __m256d s = _mm256_add_pd(a, b);
+    error = _mm256_sub_pd(b, _mm256_sub_pd(s, a));
+    return s;
+}
+
+FRACTAL_MP_TARGET inline __m256d TwoSum(__m256d a, __m256d b, __m256d& error)
+{
+    const __m256d s = _mm256_add_pd(a, b);
+    const __m256d bb = _mm256_sub_pd(s, a);
+    error = _mm256_add_pd(_mm256_sub_pd(a, _mm256_sub_pd(s, bb)), _mm256_sub_pd(b, bb));
+    return s;
+}
+
+FRACTAL_MP_TARGET inline __m256d TwoProduct(__m256d a, __m256d b, __m256d& error)
+{
+    const __m256d p = _mm256_mul_pd(a, b);
+    error = _mm256_fmsub_pd(a, b, p);
+    return p;
+}
+
+FRACTAL_MP_TARGET inline __m256d Negate(__m256d a)
+{
+    return _mm256_xor_pd(a, _mm256_set1_pd(-0.0));
+}
+
+// std::array would drop the alignment attributes of __m256d
+template <size_t kLimbs>
+struct MultiDouble4
+{
+    __m256d& operator[](size_t index)
+    {
+        return limbs[index];
+    }
+
+    const __m256d& operator[](size_t index) const
+    {
+        return limbs[index];
+    }
+
+    __m256d limbs[kLimbs];
+};
+
+template <size_t kLimbs>
+FRACTAL_MP_TARGET inline MultiDouble4<kLimbs> Negate(const MultiDouble4<kLimbs>& a)
+{
+    MultiDouble4<kLimbs> r;
+    for (size_t limb = 0; limb != kLimbs; ++limb)
+    {
+        r[limb] = Negate(a[limb]);
+    }
+    return r;
+}
+
+// a <= b for values with limbs compared lexicographically
+template <size_t kLimbs>
+FRACTAL_MP_TARGET inline __m256d LessOrEqual(const MultiDouble4<kLimbs>& a, const MultiDouble4<kLimbs>& b)
+{
+    __m256d r = _mm256_cmp_pd(a[kLimbs - 1], b[kLimbs - 1], _CMP_LE_OQ);
+    for (size_t limb = kLimbs - 1; limb-- != 0;)
+    {
+        const __m256d lt = _mm256_cmp_pd(a[limb], b[limb], _CMP_LT_OQ);
+        const __m256d le = _mm256_cmp_pd(a[limb], b[limb], _CMP_LE_OQ);
+        r = _mm256_or_pd(lt, _mm256_and_pd(le, r));
+    }
+    return r;
+}
+
+using DoubleDouble4 = MultiDouble4<2>;
+
+FRACTAL_MP_TARGET inline DoubleDouble4 Add(const DoubleDouble4& a, const DoubleDouble4& b)
+{
+    __m256d s2;
+    __m256d t2;
+    __m256d s1 = TwoSum(a[0], b[0], s2);
+    const __m256d t1 = TwoSum(a[1], b[1], t2);
+    s2 = _mm256_add_pd(s2, t1);
+    s1 = QuickTwoSum(s1, s2, s2);
+    s2 = _mm256_add_pd(s2, t2);
+    DoubleDouble4 r;
+    r[0] = QuickTwoSum(s1, s2, r[1]);
+    return r;
+}
+
+FRACTAL_MP_TARGET inline DoubleDouble4 Mul(const DoubleDouble4& a, const DoubleDouble4& b)
+{
+    __m256d p2;
+    const __m256d p1 = TwoProduct(a[0], b[0], p2);
+    p2 = _mm256_add_pd(p2, _mm256_add_pd(_mm256_mul_pd(a[0], b[1]), _mm256_mul_pd(a[1], b[0])));
+    DoubleDouble4 r;
+    r[0] = QuickTwoSum(p1, p2, r[1]);
+    return r;
+}
+
+using QuadDouble4 = MultiDouble4<4>;
+
+FRACTAL_MP_TARGET inline void ThreeSum(__m256d& a, __m256d& b, __m256d& c)
+{
+    __m256d t2;
+    __m256d t3;
+    const __m256d t1 = TwoSum(a, b, t2);
+    a = TwoSum(c, t1, t3);
+    b = TwoSum(t2, t3, c);
+}
+
+FRACTAL_MP_TARGET inline void ThreeSum2(__m256d& a, __m256d& b, __m256d c)
+{
+    __m256d t2;
+    __m256d t3;
+    const __m256d t1 = TwoSum(a, b, t2);
+    a = TwoSum(c, t1, t3);
+    b = _mm256_add_pd(t2, t3);
+}
+
+FRACTAL_MP_TARGET inline QuadDouble4 Renormalize(__m256d c0, __m256d c1, __m256d c2, __m256d c3, __m256d c4)
+{
+    __m256d s = QuickTwoSum(c3, c4, c4);
+    s = QuickTwoSum(c2, s, c3);
+    s = QuickTwoSum(c1, s, c2);
+    c0 = QuickTwoSum(c0, s, c1);
+
+    c1 = QuickTwoSum(c1, c2, c2);
+    c2 = QuickTwoSum(c2, c3, c3);
+    c3 = _mm256_add_pd(c3, c4);
+    return {c0, c1, c2, c3};
+}
+
+FRACTAL_MP_TARGET inline QuadDouble4 Add(const QuadDouble4& a, const QuadDouble4& b)
+{
+    __m256d t0;
+    __m256d t1;
+    __m256d t2;
+    __m256d t3;
+
+    const __m256d s0 = TwoSum(a[0], b[0], t0);
+    __m256d s1 = TwoSum(a[1], b[1], t1);
+    __m256d s2 = TwoSum(a[2], b[2], t2);
+    __m256d s3 = TwoSum(a[3], b[3], t3);
+
+    s1 = TwoSum(s1, t0, t0);
+    ThreeSum(s2, t0, t1);
+    ThreeSum2(s3, t0, t2);
+    t0 = _mm256_add_pd(_mm256_add_pd(t0, t1), t3);
+
+    return Renormalize(s0, s1, s2, s3, t0);
+}
+
+FRACTAL_MP_TARGET inline QuadDouble4 Mul(const QuadDouble4& a, const QuadDouble4& b)
+{
+    __m256d q0;
+    __m256d q1;
+    __m256d q2;
+    __m256d q3;
+    __m256d q4;
+    __m256d q5;
+    __m256d t0;
+    __m256d t1;
+
+    const __m256d p0 = TwoProduct(a[0], b[0], q0);
+    __m256d p1 = TwoProduct(a[0], b[1], q1);
+    __m256d p2 = TwoProduct(a[1], b[0], q2);
+    __m256d p3 = TwoProduct(a[0], b[2], q3);
+    __m256d p4 = TwoProduct(a[1], b[1], q4);
+    __m256d p5 = TwoProduct(a[2], b[0], q5);
+
+    ThreeSum(p1, p2, q0);
+
+    ThreeSum(p2, q1, q2);
+    ThreeSum(p3, p4, p5);
+    const __m256d s0 = TwoSum(p2, p3, t0);
+    __m256d s1 = TwoSum(q1, p4, t1);
+    __m256d s2 = _mm256_add_pd(q2, p5);
+    s1 = TwoSum(s1, t0, t0);
+    s2 = _mm256_add_pd(s2, _mm256_add_pd(t0, t1));
+
+    __m256d e = _mm256_mul_pd(a[0], b[3]);
+    e = _mm256_add_pd(e, _mm256_mul_pd(a[1], b[2]));
+    e = _mm256_add_pd(e, _mm256_mul_pd(a[2], b[1]));
+    e = _mm256_add_pd(e, _mm256_mul_pd(a[3], b[0]));
+    e = _mm256_add_pd(e, q0);
+    e = _mm256_add_pd(e, q3);
+    e = _mm256_add_pd(e, q4);
+    e = _mm256_add_pd(e, q5);
+    s1 = _mm256_add_pd(s1, e);
+
+    return Renormalize(p0, p1, s0, s1, s2);
+}
+
+template <size_t kLimbs>
+FRACTAL_MP_TARGET inline __m256d Equal(const MultiDouble4<kLimbs>& a, const MultiDouble4<kLimbs>& b)
+{
+    __m256d r = _mm256_cmp_pd(a[0], b[0], _CMP_EQ_OQ);
+    for (size_t limb = 1; limb != kLimbs; ++limb)
+    {
+        r = _mm256_and_pd(r, _mm256_cmp_pd(a[limb], b[limb], _CMP_EQ_OQ));
+    }
+    return r;
+}
+
+template <size_t kLimbs>
+FRACTAL_MP_TARGET inline MultiDouble4<kLimbs> Blend(
+    const MultiDouble4<kLimbs>& a,
+    const MultiDouble4<kLimbs>& b,
+    __m256d mask)
+{
+    MultiDouble4<kLimbs> r;
+    for (size_t limb = 0; limb != kLimbs; ++limb)
+    {
+        r[limb] = _mm256_blendv_pd(a[limb], b[limb], mask);
+    }
+    return r;
+}
+
+template <size_t kLimbs>
+FRACTAL_MP_TARGET inline MultiDouble4<kLimbs> Sub(const MultiDouble4<kLimbs>& a, const MultiDouble4<kLimbs>& b)
+{
+    return Add(a, Negate(b));
+}
+
+template <typename T>
+FRACTAL_MP_TARGET void MandelbrotRunMultiDoubleAVX2(const PixelRun<T>& run)
+{
+    using Lanes = RunLanes<T, 4>;
+    constexpr size_t kLimbs = Lanes::kLimbs;
+    using Value = MultiDouble4<kLimbs>;
+    Lanes lanes(run);
+
+    auto load = [](const typename Lanes::Limbs& limbs)
+    {
+        Value r;
+        for (size_t limb = 0; limb != kLimbs; ++limb)
+        {
+            r[limb] = _mm256_load_pd(limbs[limb].data());
+        }
+        return r;
+    };
+
+    auto store = [](typename Lanes::Limbs& limbs, const Value& value)
+    {
+        for (size_t limb = 0; limb != kLimbs; ++limb)
+        {
+            _mm256_store_pd(limbs[limb].data(), value[limb]);
+        }
+    };
+
+    Value four;
+    for (size_t limb = 0; limb != kLimbs; ++limb)
+    {
+        four[limb] = _mm256_set1_pd(limb == 0 ? 4.0 : 0.0);
+    }
+
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d max_iter = _mm256_set1_pd(lanes.max_iterations_limb);
+
+    while (lanes.live_mask)
+    {
+        const Value cx = load(lanes.cx);
+        const Value cy = load(lanes.cy);
+        Value x2 = load(lanes.x2);
+        Value y2 = load(lanes.y2);
+        Value w = load(lanes.w);
+        __m256d iteration = _mm256_load_pd(lanes.iteration.data());
+        Value saved_x = load(lanes.saved_x);
+        Value saved_y = load(lanes.saved_y);
+        __m256d checkpoint = _mm256_load_pd(lanes.checkpoint.data());
+        __m256d periodic = _mm256_setzero_pd();
+
+        uint32_t finished = 0;
+        while (true)
+        {
+            const __m256d in_radius = LessOrEqual(Add(x2, y2), four);
+            const __m256d below_max = _mm256_cmp_pd(iteration, max_iter, _CMP_NEQ_OQ);
+            const __m256d running = _mm256_andnot_pd(periodic, _mm256_and_pd(in_radius, below_max));
+            const auto active = static_cast<uint32_t>(_mm256_movemask_pd(running));
+            finished = ~active & lanes.live_mask;
+            if (finished)
+            {
+                break;
+            }
+
+            const Value x = Add(Sub(x2, y2), cx);
+            const Value y = Add(Sub(Sub(w, x2), y2), cy);
+            x2 = Mul(x, x);
+            y2 = Mul(y, y);
+            const Value s = Add(x, y);
+            w = Mul(s, s);
+            iteration = _mm256_add_pd(iteration, one);
+
+            periodic = _mm256_and_pd(Equal(x, saved_x), Equal(y, saved_y));
+            const __m256d at_checkpoint = _mm256_cmp_pd(iteration, checkpoint, _CMP_EQ_OQ);
+            if (!_mm256_testz_pd(at_checkpoint, at_checkpoint))
+            {
+                saved_x = Blend(saved_x, x, at_checkpoint);
+                saved_y = Blend(saved_y, y, at_checkpoint);
+                checkpoint = _mm256_blendv_pd(checkpoint, _mm256_add_pd(checkpoint, checkpoint), at_checkpoint);
+            }
+        }
+
+        store(lanes.x2, x2);
+        store(lanes.y2, y2);
+        store(lanes.w, w);
+        _mm256_store_pd(lanes.iteration.data(), iteration);
+        store(lanes.saved_x, saved_x);
+        store(lanes.saved_y, saved_y);
+        _mm256_store_pd(lanes.checkpoint.data(), checkpoint);
+        lanes.Refill(finished, static_cast<uint32_t>(_mm256_movemask_pd(periodic)));
+    }
+}
+
+#endif
+
+template <typename T>
+void MandelbrotRunMultiDouble(const PixelRun<T>& run)
+{
+#if FRACTAL_X86_SIMD
+    if (GetSimdIsa() != SimdIsa::Scalar && HasFma())
+    {
+        MandelbrotRunMultiDoubleAVX2(run);
+        return;
+    }
+#endif
+
+    MandelbrotRunScalar(run);
+}
+
+void MandelbrotRun(const PixelRun<float>& run)
+{
+    switch (GetSimdIsa())
+    {
+#if FRACTAL_X86_SIMD
+    case SimdIsa::AVX512:
+        MandelbrotRunSingleAVX512(run);
+        break;
+    case SimdIsa::AVX2:
+        MandelbrotRunSingleAVX2(run);
+        break;
+#endif
+    default:
+        MandelbrotRunScalar(run);
+        break;
+    }
+}
+
+void MandelbrotRun(const PixelRun<double>& run)
+{
+    switch (GetSimdIsa())
+    {
+#if FRACTAL_X86_SIMD
+    case SimdIsa::AVX512:
+        MandelbrotRunAVX512(run);
+        break;
+    case SimdIsa::AVX2:
+        MandelbrotRunAVX2(run);
+        break;
+#endif
+    default:
+        MandelbrotRunScalar(run);
+        break;
+    }
+}
+
+void MandelbrotRun(const PixelRun<DoubleDouble>& run)
+{
+    MandelbrotRunMultiDouble(run);
+}
+
+void MandelbrotRun(const PixelRun<QuadDouble>& run)
+{
+    MandelbrotRunMultiDouble(run);
+}
+
+}  // namespace
+
+void MandelbrotRow(
+    float x0,
+    float dx,
+    float y0,
+    size_t max_iterations,
+    size_t first_pixel,
+    std::span<uint32_t> out,
+    MandelbrotStats& stats)
+{
+    MandelbrotRun(PixelRun{x0, y0, dx, dx, RunShape::Row, first_pixel, {}, max_iterations, out, stats});
+}
+
+void MandelbrotColumn(
+    float x0,
+    float y0,
+    float dy,
+    size_t max_iterations,
+    size_t first_pixel,
+    std::span<uint32_t> out,
+    MandelbrotStats& stats)
+{
+    MandelbrotRun(PixelRun{x0, y0, dy, dy, RunShape::Column, first_pixel, {}, max_iterations, out, stats});
+}
+
+void MandelbrotPixels(
+    float x0,
+    float y0,
+    float dx,
+    float dy,
+    size_t max_iterations,
+    std::span<const PixelIndex> pixels,
+    std::span<uint32_t> out,
+    MandelbrotStats& stats)
+{
+    MandelbrotRun(PixelRun{x0, y0, dx, dy, RunShape::Scattered, 0, pixels, max_iterations, out, stats});
+}
+
+void MandelbrotRow(
+    double x0,
+    double dx,
+    double y0,
+    size_t max_iterations,
+    size_t first_pixel,
+    std::span<uint32_t> out,
+    MandelbrotStats& stats)
+{
+    MandelbrotRun(PixelRun{x0, y0, dx, dx, RunShape::Row, first_pixel, {}, max_iterations, out, stats});
+}
+
+void MandelbrotColumn(
+    double x0,
+    double y0,
+    double dy,
+    size_t max_iterations,
+    size_t first_pixel,
+    std::span<uint32_t> out,
+    MandelbrotStats& stats)
+{
+    MandelbrotRun(PixelRun{x0, y0, dy, dy, RunShape::Column, first_pixel, {}, max_iterations, out, stats});
+}
+
+void MandelbrotPixels(
+    double x0,
+    double y0,
+    double dx,
+    double dy,
+    size_t max_iterations,
+    std::span<const PixelIndex> pixels,
+    std::span<uint32_t> out,
+    MandelbrotStats& stats)
+{
+    MandelbrotRun(PixelRun{x0, y0, dx, dy, RunShape::Scattered, 0, pixels, max_iterations, out, stats});
+}
+
+void MandelbrotRow(
+    const DoubleDouble& x0,
+    const DoubleDouble& dx,
+    const DoubleDouble& y0,
+    size_t max_iterations,
+    size_t first_pixel,
+    std::span<uint32_t> out,
+    MandelbrotStats& stats)
+{
+    MandelbrotRun(PixelRun{x0, y0, dx, dx, RunShape::Row, first_pixel, {}, max_iterations, out, stats});
+}
+
+void MandelbrotColumn(
+    const DoubleDouble& x0,
+    const DoubleDouble& y0,
+    const DoubleDouble& dy,
+    size_t max_iterations,
+    size_t first_pixel,
+    std::span<uint32_t> out,
+    MandelbrotStats& stats)
+{
+    MandelbrotRun(PixelRun{x0, y0, dy, dy, RunShape::Column, first_pixel, {}, max_iterations, out, stats});
+}
+
+void MandelbrotPixels(
+    const DoubleDouble& x0,
+    const DoubleDouble& y0,
+    const DoubleDouble& dx,
+    const DoubleDouble& dy,
+    size_t max_iterations,
+    std::span<const PixelIndex> pixels,
+    std::span<uint32_t> out,
+    MandelbrotStats& stats)
+{
+    MandelbrotRun(PixelRun{x0, y0, dx, dy, RunShape::Scattered, 0, pixels, max_iterations, out, stats});
+}
+
+void MandelbrotRow(
+    const QuadDouble& x0,
+    const QuadDouble& dx,
+    const QuadDouble& y0,
+    size_t max_iterations,
+    size_t first_pixel,
+    std::span<uint32_t> out,
+    MandelbrotStats& stats)
+{
+    MandelbrotRun(PixelRun{x0, y0, dx, dx, RunShape::Row, first_pixel, {}, max_iterations, out, stats});
+}
+
+void MandelbrotColumn(
+    const QuadDouble& x0,
+    const QuadDouble& y0,
+    const QuadDouble& dy,
+    size_t max_iterations,
+    size_t first_pixel,
+    std::span<uint32_t> out,
+    MandelbrotStats& stats)
+{
+    MandelbrotRun(PixelRun{x0, y0, dy, dy, RunShape::Column, first_pixel, {}, max_iterations, out, stats});
+}
+
+void MandelbrotPixels(
+    const QuadDouble& x0,
+    const QuadDouble& y0,
+    const QuadDouble& dx,
+    const QuadDouble& dy,
+    size_t max_iterations,
+    std::span<const PixelIndex> pixels,
+    std::span<uint32_t> out,
+    MandelbrotStats& stats)
+{
+    MandelbrotRun(PixelRun{x0, y0, dx, dy, RunShape::Scattered, 0, pixels, max_iterations, out, stats});
+}
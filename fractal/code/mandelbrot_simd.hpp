@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "double_double.hpp"
+#include "iteration_grid.hpp"
+#include "mandelbrot.hpp"
+#include "quad_double.hpp"
+
+// Escape time of a run of pixels in a row: pixel i is located at (x0 + dx * i, y0)
+// and out receives pixels [first_pixel, first_pixel + out.size()).
+// Produces the same values as MandelbrotLoop<T> for every pixel but evaluates
+// several pixels per instruction. A lane that escapes is immediately refilled with
+// the next pixel of the row so that lanes do not idle near the set boundary.
+// Iterations skipped by interior checks are added to stats.
+// The float overload supports up to 2^24 iterations (FractalSettings::max_iterations_limit).
+void MandelbrotRow(
+    float x0,
+    float dx,
+    float y0,
+    size_t max_iterations,
+    size_t first_pixel,
+    std::span<uint32_t> out,
+    MandelbrotStats& stats);
+void MandelbrotRow(
+    double x0,
+    double dx,
+    double y0,
+    size_t max_iterations,
+    size_t first_pixel,
+    std::span<uint32_t> out,
+    MandelbrotStats& stats);
+void MandelbrotRow(
+    const DoubleDouble& x0,
+    const DoubleDouble& dx,
+    const DoubleDouble& y0,
+    size_t max_iterations,
+    size_t first_pixel,
+    std::span<uint32_t> out,
+    MandelbrotStats& stats);
+void MandelbrotRow(
+    const QuadDouble& x0,
+    const QuadDouble& dx,
+    const QuadDouble& y0,
+    size_t max_iterations,
+    size_t first_pixel,
+    std::span<uint32_t> out,
+    MandelbrotStats& stats);
+
+// Same for a run of pixels in a column: pixel i is located at (x0, y0 + dy * i)
+void MandelbrotColumn(
+    float x0,
+    float y0,
+    float dy,
+    size_t max_iterations,
+    size_t first_pixel,
+    std::span<uint32_t> out,
+    MandelbrotStats& stats);
+void MandelbrotColumn(
+    double x0,
+    double y0,
+    double dy,
+    size_t max_iterations,
+    size_t first_pixel,
+    std::span<uint32_t> out,
+    MandelbrotStats& stats);
+void MandelbrotColumn(
+    const DoubleDouble& x0,
+    const DoubleDouble& y0,
+    const DoubleDouble& dy,
+    size_t max_iterations,
+    size_t first_pixel,
+    std::span<uint32_t> out,
+    MandelbrotStats& stats);
+void MandelbrotColumn(
+    const QuadDouble& x0,
+    const QuadDouble& y0,
+    const QuadDouble& dy,
+    size_t max_iterations,
+    size_t first_pixel,
+    std::span<uint32_t> out,
+    MandelbrotStats& stats);
+
+// Same for scattered pixels: pixel i is located at (x0 + dx * pixels[i].x, y0 + dy * pixels[i].y)
+void MandelbrotPixels(
+    float x0,
+    float y0,
+    float dx,
+    float dy,
+    size_t max_iterations,
+    std::span<const PixelIndex> pixels,
+    std::span<uint32_t> out,
+    MandelbrotStats& stats);
+void MandelbrotPixels(
+    double x0,
+    double y0,
+    double dx,
+    double dy,
+    size_t max_iterations,
+    std::span<const PixelIndex> pixels,
+    std::span<uint32_t> out,
+    MandelbrotStats& stats);
+void MandelbrotPixels(
+    const DoubleDouble& x0,
+    const DoubleDouble& y0,
+    const DoubleDouble& dx,
+    const DoubleDouble& dy,
+    size_t max_iterations,
+    std::span<const PixelIndex> pixels,
+    std::span<uint32_t> out,
+    MandelbrotStats& stats);
+void MandelbrotPixels(
+    const QuadDouble& x0,
+    const QuadDouble& y0,
+    const QuadDouble& dx,
+    const QuadDouble& dy,
+    size_t max_iterations,
+    std::span<const PixelIndex> pixels,
+    std::span<uint32_t> out,
+    MandelbrotStats& stats);
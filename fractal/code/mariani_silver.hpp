@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "iteration_grid.hpp"
+#include "mandelbrot.hpp"
+
+// Mariani-Silver subdivision. The border of a rectangle is iterated first: when all border pixels
+// have the same value the inside is filled with it, otherwise the rectangle is split in two halves
+// sharing the dividing line. The set and its escape bands are connected, so a uniform border rarely
+// hides anything, but the result is not guaranteed to match iterating every pixel.
+// Evaluator iterates runs of pixels into the grid: ComputeRow(x, y, count) pixels [x, x + count) of row y
+// and ComputeColumn(x, y, count) pixels [y, y + count) of column x.
+template <typename Evaluator>
+class MarianiSilverFill
+{
+public:
+    // Smaller rectangles are iterated directly: short runs do not fill SIMD lanes
+    static constexpr size_t kMinSide = 8;
+
+    MarianiSilverFill(IterationGrid grid, Evaluator& evaluator, MandelbrotStats& stats)
+        : grid_(grid),
+          evaluator_(evaluator),
+          stats_(stats)
+    {
+    }
+
+    void Run()
+    {
+        if (grid_.width == 0 || grid_.height == 0)
+        {
+            return;
+        }
+
+        const Rect full{0, 0, grid_.width - 1, grid_.height - 1};
+        evaluator_.ComputeRow(0, full.y0, grid_.width);
+        if (full.y1 != full.y0)
+        {
+            evaluator_.ComputeRow(0, full.y1, grid_.width);
+        }
+
+        ComputeColumn(full.x0, full.y0 + 1, full.y1);
+        if (full.x1 != full.x0)
+        {
+            ComputeColumn(full.x1, full.y0 + 1, full.y1);
+        }
+
+        Subdivide(full);
+    }
+
+private:
+    // Inclusive bounds
+    struct Rect
+    {
+        size_t x0 = 0;
+        size_t y0 = 0;
+        size_t x1 = 0;
+        size_t y1 = 0;
+    };
+
+    // Pixels [y_begin, y_end) of column x
+    void ComputeColumn(size_t x, size_t y_begin, size_t y_end)
+    {
+        if (y_begin < y_end)
+        {
+            evaluator_.ComputeColumn(x, y_begin, y_end - y_begin);
+        }
+    }
+
+    bool HasUniformBorder(const Rect& rect, uint32_t& value) const
+    {
+        value = grid_.At(rect.x0, rect.y0);
+        for (size_t x = rect.x0; x <= rect.x1; ++x)
+        {
+            if (grid_.At(x, rect.y0) != value || grid_.At(x, rect.y1) != value)
+            {
+                return false;
+            }
+        }
+
+        for (size_t y = rect.y0 + 1; y < rect.y1; ++y)
+        {
+            if (grid_.At(rect.x0, y) != value || grid_.At(rect.x1, y) != value)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // The border of rect is already computed
+    void Subdivide(const Rect& rect)
+    {
+        const size_t width = rect.x1 - rect.x0;
+        const size_t height = rect.y1 - rect.y0;
+        if (width < 2 || height < 2)
+        {
+            return;
+        }
+
+        uint32_t value = 0;
+        if (HasUniformBorder(rect, value))
+        {
+            for (size_t y = rect.y0 + 1; y != rect.y1; ++y)
+            {
+                for (size_t x = rect.x0 + 1; x != rect.x1; ++x)
+                {
+                    grid_.At(x, y) = value;
+                }
+            }
+
+            stats_.pixels_filled += (width - 1) * (height - 1);
+            return;
+        }
+
+        if (width < kMinSide || height < kMinSide)
+        {
+            for (size_t y = rect.y0 + 1; y != rect.y1; ++y)
+            {
+                evaluator_.ComputeRow(rect.x0 + 1, y, width - 1);
+            }
+            return;
+        }
+
+        if (width >= height)
+        {
+            const size_t middle = rect.x0 + width / 2;
+            ComputeColumn(middle, rect.y0 + 1, rect.y1);
+            Subdivide({rect.x0, rect.y0, middle, rect.y1});
+            Subdivide({middle, rect.y0, rect.x1, rect.y1});
+        }
+        else
+        {
+            const size_t middle = rect.y0 + height / 2;
+            evaluator_.ComputeRow(rect.x0 + 1, middle, width - 1);
+            Subdivide({rect.x0, rect.y0, rect.x1, middle});
+            Subdivide({rect.x0, middle, rect.x1, rect.y1});
+        }
+    }
+
+private:
+    IterationGrid grid_;
+    Evaluator& evaluator_;
+    MandelbrotStats& stats_;
+};
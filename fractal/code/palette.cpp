@@ -0,0 +1,104 @@
+#include "palette.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+#include "cpu_features.hpp"
+
+#if FRACTAL_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace
+{
+
+constexpr uint32_t kOpaqueBlack = 0xFF000000u;
+
+uint32_t PackRgba(const Eigen::Vector3f& color)
+{
+    uint32_t rgba = kOpaqueBlack;
+    for (uint32_t channel = 0; channel != 3; ++channel)
+    {
+        const float value = std::clamp(color[channel], 0.0f, 1.0f) * 255.0f;
+        rgba |= static_cast<uint32_t>(value) << (8 * channel);
+    }
+
+    return rgba;
+}
+
+void ColorizeScalar(std::span<const uint32_t> table, std::span<const uint32_t> iterations, std::span<uint32_t> rgba)
+{
+    const uint32_t max_iterations = static_cast<uint32_t>(table.size() - 1);
+    for (size_t index = 0; index != iterations.size(); ++index)
+    {
+        rgba[index] = table[std::min(iterations[index], max_iterations)];
+    }
+}
+
+#if FRACTAL_X86_SIMD
+
+[[gnu::target("avx2")]] void
+ColorizeAVX2(std::span<const uint32_t> table, std::span<const uint32_t> iterations, std::span<uint32_t> rgba)
+{
+    const uint32_t max_iterations = static_cast<uint32_t>(table.size() - 1);
+    const __m256i max_index = _mm256_set1_epi32(static_cast<int>(max_iterations));
+    const auto* table_data = reinterpret_cast<const int*>(table.data());
+
+    size_t index = 0;
+    for (; index + 8 <= iterations.size(); index += 8)
+    {
+        const __m256i counts = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(iterations.data() + index));
+        const __m256i lut_index = _mm256_min_epu32(counts, max_index);
+        const __m256i colors = _mm256_i32gather_epi32(table_data, lut_index, 4);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(rgba.data() + index), colors);
+    }
+
+    ColorizeScalar(table, iterations.subspan(index), rgba.subspan(index));
+}
+
+#endif
+
+}  // namespace
+
+void PaletteLut::Build(std::span<const Eigen::Vector3f> colors, uint32_t max_iterations)
+{
+    assert(colors.size() >= 2);
+    assert(max_iterations >= colors.size());
+    // Gather indices are signed 32-bit integers
+    assert(max_iterations <= static_cast<uint32_t>(std::numeric_limits<int32_t>::max()));
+
+    max_iterations_ = max_iterations;
+    table_.resize(size_t{max_iterations} + 1);
+
+    // Iteration i lies at i * segments / max_iterations along the gradient. Integer part selects
+    // the segment and the remainder of the same division is the position within it.
+    const size_t segments_count = colors.size() - 1;
+    for (size_t iteration = 0; iteration != max_iterations; ++iteration)
+    {
+        const size_t k = iteration * segments_count;
+        const size_t segment = k / max_iterations;
+        const float p = static_cast<float>(k % max_iterations) / static_cast<float>(max_iterations);
+        const Eigen::Vector3f& color_a = colors[segment];
+        const Eigen::Vector3f& color_b = colors[segment + 1];
+        table_[iteration] = PackRgba(color_a + (color_b - color_a) * p);
+    }
+
+    table_[max_iterations] = kOpaqueBlack;
+}
+
+void PaletteLut::Colorize(std::span<const uint32_t> iterations, std::span<uint32_t> rgba) const
+{
+    assert(!table_.empty());
+    assert(rgba.size() >= iterations.size());
+
+#if FRACTAL_X86_SIMD
+    if (GetSimdIsa() != SimdIsa::Scalar)
+    {
+        ColorizeAVX2(table_, iterations, rgba);
+        return;
+    }
+#endif
+
+    ColorizeScalar(table_, iterations, rgba);
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "wrap_eigen.hpp"
+
+// RGBA8 color (R in the lowest byte) of every iteration count for one palette and max iterations.
+// Colors are interpolated along equal segments of [0, max_iterations), pixels that did not escape
+// are black. Rebuilt only when the palette or max iterations change.
+class PaletteLut
+{
+public:
+    void Build(std::span<const Eigen::Vector3f> colors, uint32_t max_iterations);
+
+    // Converts iteration counts to RGBA8 in bulk with AVX2 gathers when available.
+    // Counts above max iterations are black too.
+    void Colorize(std::span<const uint32_t> iterations, std::span<uint32_t> rgba) const;
+
+    uint32_t GetMaxIterations() const
+    {
+        return max_iterations_;
+    }
+
+private:
+    std::vector<uint32_t> table_;
+    uint32_t max_iterations_ = 0;
+};
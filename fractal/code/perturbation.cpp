@@ -0,0 +1,309 @@
+#include "perturbation.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <type_traits>
+
+#include "real_traits.hpp"
+
+namespace
+{
+
+// Truncation error of the series relative to the size of a pixel. Escape times of pixels deep in
+// chaotic regions change with errors far below a pixel, so it is kept close to the rounding error of
+// the double deltas themselves.
+constexpr double kSeriesTolerance = 1e-12;
+
+// High precision iterations between polls of the cancel predicate
+constexpr size_t kCancelCheckInterval = 256;
+
+// Cancellation is not signalled, so waiting workers poll their predicate
+constexpr auto kCancelPollInterval = std::chrono::milliseconds(1);
+
+struct Complex
+{
+    double re = 0.0;
+    double im = 0.0;
+
+    Complex operator+(const Complex& other) const
+    {
+        return {re + other.re, im + other.im};
+    }
+
+    Complex operator*(const Complex& other) const
+    {
+        return {re * other.re - im * other.im, re * other.im + im * other.re};
+    }
+
+    Complex operator*(double k) const
+    {
+        return {re * k, im * k};
+    }
+
+    double Norm() const
+    {
+        return std::hypot(re, im);
+    }
+
+    bool IsFinite() const
+    {
+        return std::isfinite(re) && std::isfinite(im);
+    }
+};
+
+}  // namespace
+
+std::unique_ptr<ReferenceOrbit> ReferenceOrbit::TryCompute(
+    const Parameters& params,
+    const CancelPredicate& is_cancelled)
+{
+    std::unique_ptr<ReferenceOrbit> orbit(new ReferenceOrbit());
+    if (!orbit->ComputeOrbit(params, is_cancelled))
+    {
+        return nullptr;
+    }
+
+    if (params.use_series_approximation)
+    {
+        orbit->ComputeSeries(params);
+    }
+
+    return orbit;
+}
+
+bool ReferenceOrbit::ComputeOrbit(const Parameters& params, const CancelPredicate& is_cancelled)
+{
+    zx_.clear();
+    zy_.clear();
+    zx_.push_back(0.0);
+    zy_.push_back(0.0);
+
+    return VisitMultiFloat(
+        params.digits,
+        [&]<typename Real>(std::type_identity<Real>)
+        {
+            const auto cx = RealCast<Real>(params.center.x());
+            const auto cy = RealCast<Real>(params.center.y());
+            Real x{0};
+            Real y{0};
+
+            for (size_t iteration = 0; iteration != params.max_iterations; ++iteration)
+            {
+                if (iteration % kCancelCheckInterval == 0 && is_cancelled())
+                {
+                    return false;
+                }
+
+                const Real x2 = x * x;
+                const Real y2 = y * y;
+                if (x2 + y2 > 4)
+                {
+                    break;
+                }
+
+                Real new_y = x * y;
+                new_y *= 2;
+                new_y += cy;
+                x = x2 - y2 + cx;
+                y = new_y;
+
+                zx_.push_back(static_cast<double>(x));
+                zy_.push_back(static_cast<double>(y));
+            }
+
+            return true;
+        });
+}
+
+void ReferenceOrbit::ComputeSeries(const Parameters& params)
+{
+    if (params.max_delta <= 0.0 || params.pixel_size <= 0.0)
+    {
+        return;
+    }
+
+    max_delta_ = params.max_delta;
+
+    // Probe points on the circle that encloses the frame and on two circles inside of it. They are
+    // iterated exactly and the series is accepted only while it agrees with all of them.
+    constexpr double kDiagonal = 0.70710678118654752;
+    constexpr std::array<Complex, 8> kDirections{
+        {{1.0, 0.0},
+         {-1.0, 0.0},
+         {0.0, 1.0},
+         {0.0, -1.0},
+         {kDiagonal, kDiagonal},
+         {kDiagonal, -kDiagonal},
+         {-kDiagonal, kDiagonal},
+         {-kDiagonal, -kDiagonal}}};
+    constexpr std::array<double, 3> kProbeRadii{1.0, 0.5, 0.25};
+    std::array<Complex, kDirections.size() * kProbeRadii.size()> probes{};
+    for (size_t index = 0; index != probes.size(); ++index)
+    {
+        probes[index] = kDirections[index % kDirections.size()] * kProbeRadii[index / kDirections.size()];
+    }
+    std::array<Complex, probes.size()> probe_deltas{};
+
+    // Coefficients are multiplied by max_delta, max_delta^2, max_delta^3 and max_delta^4 respectively.
+    // The fourth one is not used by pixels, it estimates the truncation error of the other three.
+    Complex a;
+    Complex b;
+    Complex c;
+    Complex d;
+
+    // Never skip the last reference point: pixels need at least one regular iteration
+    const size_t last = GetLength();
+    for (size_t n = 0; n + 1 < last; ++n)
+    {
+        const Complex z{zx_[n], zy_[n]};
+        const Complex two_z = z * 2;
+        const Complex next_a = two_z * a + Complex{max_delta_, 0.0};
+        const Complex next_b = two_z * b + a * a;
+        const Complex next_c = two_z * c + a * b * 2;
+        const Complex next_d = two_z * d + a * c * 2 + b * b;
+
+        if (!next_a.IsFinite() || !next_b.IsFinite() || !next_c.IsFinite() || !next_d.IsFinite())
+        {
+            break;
+        }
+
+        // Error in delta moves the pixel by error / |dDelta/dc|. The derivative is (A + 2Bu + 3Cu^2 + ...)
+        // and its smallest value anywhere in the frame is bounded from below by the terms that can cancel A.
+        const double min_derivative = next_a.Norm() - 2 * next_b.Norm() - 3 * next_c.Norm() - 4 * next_d.Norm();
+        const double max_error = kSeriesTolerance * params.pixel_size * min_derivative / max_delta_;
+
+        // Terms from the fourth order on are dropped. While the series converges they add up to less than
+        // twice the fourth one for |u| <= 1.
+        if (!(2 * next_d.Norm() <= max_error))
+        {
+            break;
+        }
+
+        bool probes_agree = true;
+        for (size_t probe_index = 0; probe_index != probes.size(); ++probe_index)
+        {
+            const Complex& u = probes[probe_index];
+            Complex& delta = probe_deltas[probe_index];
+            delta = (two_z + delta) * delta + u * max_delta_;
+
+            const Complex u2 = u * u;
+            const Complex series = next_a * u + next_b * u2 + next_c * (u2 * u);
+            const Complex error{series.re - delta.re, series.im - delta.im};
+            if (!(error.Norm() <= max_error))
+            {
+                probes_agree = false;
+                break;
+            }
+        }
+
+        if (!probes_agree)
+        {
+            break;
+        }
+
+        a = next_a;
+        b = next_b;
+        c = next_c;
+        d = next_d;
+        series_skip_ = n + 1;
+    }
+
+    series_a_ = {a.re, a.im};
+    series_b_ = {b.re, b.im};
+    series_c_ = {c.re, c.im};
+}
+
+size_t ReferenceOrbit::Iterate(double dcx, double dcy, size_t max_iterations) const
+{
+    size_t iteration = 0;
+    size_t ref = 0;
+    double dx = 0.0;
+    double dy = 0.0;
+
+    if (series_skip_ != 0 && series_skip_ < max_iterations)
+    {
+        const Complex u{dcx / max_delta_, dcy / max_delta_};
+        const Complex u2 = u * u;
+        const Complex u3 = u2 * u;
+        const Complex delta = Complex{series_a_[0], series_a_[1]} * u + Complex{series_b_[0], series_b_[1]} * u2 +
+                              Complex{series_c_[0], series_c_[1]} * u3;
+
+        const double zx = zx_[series_skip_] + delta.re;
+        const double zy = zy_[series_skip_] + delta.im;
+
+        // The pixel escaped somewhere inside the skipped range: iterate it from the start
+        if (zx * zx + zy * zy <= 4)
+        {
+            dx = delta.re;
+            dy = delta.im;
+            iteration = series_skip_;
+            ref = series_skip_;
+        }
+    }
+
+    const size_t last = GetLength();
+    while (iteration != max_iterations)
+    {
+        const double zx = zx_[ref] + dx;
+        const double zy = zy_[ref] + dy;
+        const double r2 = zx * zx + zy * zy;
+        if (r2 > 4)
+        {
+            break;
+        }
+
+        // Rebase to the start of the reference when the pixel gets closer to zero than
+        // its delta or when the reference itself has escaped. This avoids glitches.
+        if (ref == last || r2 < dx * dx + dy * dy)
+        {
+            dx = zx;
+            dy = zy;
+            ref = 0;
+        }
+
+        // delta' = (2 * Z + delta) * delta + dc
+        const double tx = 2 * zx_[ref] + dx;
+        const double ty = 2 * zy_[ref] + dy;
+        const double new_dx = tx * dx - ty * dy + dcx;
+        dy = tx * dy + ty * dx + dcy;
+        dx = new_dx;
+
+        ++ref;
+        ++iteration;
+    }
+
+    return iteration;
+}
+
+const ReferenceOrbit* PerturbationFrame::GetOrbit(const ReferenceOrbit::CancelPredicate& is_cancelled)
+{
+    std::unique_lock lock(mutex_);
+    while (!orbit_ && computing_)
+    {
+        if (is_cancelled())
+        {
+            return nullptr;
+        }
+
+        computed_.wait_for(lock, kCancelPollInterval);
+    }
+
+    if (orbit_)
+    {
+        return orbit_.get();
+    }
+
+    computing_ = true;
+    lock.unlock();
+    std::unique_ptr<ReferenceOrbit> orbit = ReferenceOrbit::TryCompute(params_, is_cancelled);
+    lock.lock();
+    computing_ = false;
+    if (orbit)
+    {
+        orbit_ = std::move(orbit);
+        ready_ = true;
+    }
+
+    computed_.notify_all();
+    return orbit_.get();
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "vector.hpp"
+
+// Orbit of a single reference point computed with MultiFloat and rounded to double.
+// Pixels are iterated as double precision deltas from this orbit (perturbation theory),
+// so the cost of the high precision arithmetic is paid once per frame instead of once per pixel.
+// Deltas are plain doubles, so frames narrower than about 1e-300 are out of reach.
+class ReferenceOrbit
+{
+public:
+    struct Parameters
+    {
+        Vector2f center;
+        size_t max_iterations = 0;
+        // Largest distance from the center to a pixel of the frame
+        double max_delta = 0.0;
+        double pixel_size = 0.0;
+        bool use_series_approximation = true;
+        // Decimal digits used to compute the reference orbit
+        unsigned digits = kMultiFloatDigits.back();
+    };
+
+    // Returns true when the result is not needed anymore
+    using CancelPredicate = std::function<bool()>;
+
+    // Polls is_cancelled while the high precision orbit is computed and returns nullptr if it returned true
+    static std::unique_ptr<ReferenceOrbit> TryCompute(const Parameters& params, const CancelPredicate& is_cancelled);
+
+    // Escape time of the point center + (dcx, dcy)
+    size_t Iterate(double dcx, double dcy, size_t max_iterations) const;
+
+    // Number of reference iterations before it escaped or reached max iterations
+    size_t GetLength() const
+    {
+        return zx_.size() - 1;
+    }
+
+    // Iterations every pixel skips thanks to the series approximation
+    size_t GetSeriesSkip() const
+    {
+        return series_skip_;
+    }
+
+private:
+    ReferenceOrbit() = default;
+
+    // Returns false if it was cancelled
+    bool ComputeOrbit(const Parameters& params, const CancelPredicate& is_cancelled);
+    void ComputeSeries(const Parameters& params);
+
+private:
+    std::vector<double> zx_;
+    std::vector<double> zy_;
+
+    // Delta at iteration series_skip_ is a * u + b * u^2 + c * u^3 where u = dc / max_delta.
+    // Coefficients are stored prescaled by powers of max_delta to stay in double range.
+    size_t series_skip_ = 0;
+    double max_delta_ = 1.0;
+    std::array<double, 2> series_a_{};
+    std::array<double, 2> series_b_{};
+    std::array<double, 2> series_c_{};
+};
+
+// Reference orbit shared by all tiles of a frame. It is computed by the first worker
+// that needs it so that the main thread never waits for the high precision part.
+class PerturbationFrame
+{
+public:
+    explicit PerturbationFrame(const ReferenceOrbit::Parameters& params) : params_(params) {}
+
+    // Computes the orbit or waits for another worker computing it. Returns nullptr as soon as is_cancelled
+    // returns true, so workers of a stale frame do not wait for its orbit. If the worker computing the
+    // orbit is cancelled, the next caller starts over.
+    const ReferenceOrbit* GetOrbit(const ReferenceOrbit::CancelPredicate& is_cancelled);
+
+    const Vector2f& GetCenter() const
+    {
+        return params_.center;
+    }
+
+    // Returns nullptr until the orbit is computed
+    const ReferenceOrbit* TryGetOrbit() const
+    {
+        return ready_ ? orbit_.get() : nullptr;
+    }
+
+private:
+    ReferenceOrbit::Parameters params_;
+    std::mutex mutex_;
+    std::condition_variable computed_;
+    bool computing_ = false;
+    std::unique_ptr<ReferenceOrbit> orbit_;
+    std::atomic_bool ready_ = false;
+};
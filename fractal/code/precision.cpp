@@ -0,0 +1,85 @@
+#include "precision.hpp"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+
+#include "real_traits.hpp"
+
+// Rounding errors grow with iterations so a few bits on top of the pixel size are needed
+static constexpr unsigned kGuardBits = 12;
+
+// Interesting points are within |c| <= 2 = 2^1
+static constexpr int kCoordinateExponent = 1;
+
+std::string_view ToString(FractalPrecision precision)
+{
+    switch (precision)
+    {
+    case FractalPrecision::Single:
+        return "float";
+    case FractalPrecision::Double:
+        return "double";
+    case FractalPrecision::DoubleDouble:
+        return "double-double";
+    case FractalPrecision::QuadDouble:
+        return "quad-double";
+    default:
+        return kFloatBackendName;
+    }
+}
+
+unsigned GetPrecisionBits(FractalPrecision precision, unsigned digits)
+{
+    constexpr auto kDoubleBits = static_cast<unsigned>(std::numeric_limits<double>::digits);
+    switch (precision)
+    {
+    case FractalPrecision::Single:
+        return static_cast<unsigned>(std::numeric_limits<float>::digits);
+    case FractalPrecision::Double:
+        return kDoubleBits;
+    case FractalPrecision::DoubleDouble:
+        return 2 * kDoubleBits;
+    case FractalPrecision::QuadDouble:
+        return 4 * kDoubleBits;
+    default:
+        // log2(10) ~ 3.32 bits per decimal digit
+        return digits * 332 / 100;
+    }
+}
+
+PrecisionChoice ChoosePrecision(const Float& pixel_size)
+{
+    PrecisionChoice choice;
+    choice.pixel_exponent = RealTraits<Float>::GetExponent(pixel_size);
+    choice.required_bits = static_cast<unsigned>(std::max(kCoordinateExponent - choice.pixel_exponent, 1)) + kGuardBits;
+
+    choice.digits = kMultiFloatDigits.back();
+    for (const unsigned digits : kMultiFloatDigits)
+    {
+        if (GetPrecisionBits(FractalPrecision::Multiprecision, digits) >= choice.required_bits)
+        {
+            choice.digits = digits;
+            break;
+        }
+    }
+
+    // Hardware tiers ordered from the cheapest
+    constexpr std::array<FractalPrecision, 4> kHardwareTiers{
+        FractalPrecision::Single,
+        FractalPrecision::Double,
+        FractalPrecision::DoubleDouble,
+        FractalPrecision::QuadDouble};
+
+    choice.precision = FractalPrecision::Multiprecision;
+    for (const FractalPrecision precision : kHardwareTiers)
+    {
+        if (GetPrecisionBits(precision) >= choice.required_bits)
+        {
+            choice.precision = precision;
+            break;
+        }
+    }
+
+    return choice;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+#include "float.hpp"
+
+// Number type used by the CPU backend to iterate pixels, from the cheapest to the most precise
+enum class FractalPrecision : uint8_t
+{
+    Single,
+    Double,
+    DoubleDouble,
+    QuadDouble,
+    Multiprecision
+};
+
+inline constexpr size_t kFractalPrecisionCount = 5;
+
+std::string_view ToString(FractalPrecision precision);
+
+// Significant bits of the type. For Multiprecision it depends on the number of decimal digits.
+unsigned GetPrecisionBits(FractalPrecision precision, unsigned digits = 0);
+
+struct PrecisionChoice
+{
+    FractalPrecision precision = FractalPrecision::Double;
+    // Digits of MultiFloat for the Multiprecision tier
+    unsigned digits = kMultiFloatDigits.front();
+    // Binary exponent of the pixel size
+    int pixel_exponent = 0;
+    // Bits to tell neighbor pixels apart plus guard bits for errors accumulated by iterations
+    unsigned required_bits = 0;
+};
+
+// Cheapest tier that resolves pixels of the given size
+PrecisionChoice ChoosePrecision(const Float& pixel_size);
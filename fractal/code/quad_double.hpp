@@ -0,0 +1,260 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+#include "error_free_transform.hpp"
+
+// Unevaluated sum of four doubles with about 212 significant bits (~1e-62 relative precision).
+// Addition and multiplication are the "sloppy" variants of the QD library by Hida, Li and Bailey.
+// Renormalization is branch free so that the SIMD kernel can mirror it lane by lane.
+class QuadDouble
+{
+public:
+    constexpr QuadDouble() = default;
+
+    constexpr QuadDouble(double value) : limbs{value, 0.0, 0.0, 0.0} {}
+
+    constexpr QuadDouble(double l0, double l1, double l2, double l3) : limbs{l0, l1, l2, l3} {}
+
+    // Rounds any type convertible to double with higher precision (i.e. Float)
+    template <typename Number>
+        requires(!std::is_arithmetic_v<Number>)
+    static QuadDouble FromNumber(const Number& value)
+    {
+        Number rest = value;
+        std::array<double, 4> l{};
+        for (double& limb : l)
+        {
+            limb = static_cast<double>(rest);
+            rest -= Number(limb);
+        }
+
+        const auto extra = static_cast<double>(rest);
+        Renormalize(l[0], l[1], l[2], l[3], extra);
+        return {l[0], l[1], l[2], l[3]};
+    }
+
+    explicit operator double() const
+    {
+        return limbs[0] + limbs[1] + limbs[2] + limbs[3];
+    }
+
+    QuadDouble operator-() const
+    {
+        return {-limbs[0], -limbs[1], -limbs[2], -limbs[3]};
+    }
+
+    // Sums three values keeping the exact result in a (most significant), b and c
+    static void ThreeSum(double& a, double& b, double& c)
+    {
+        double t2 = 0.0;
+        double t3 = 0.0;
+        const double t1 = TwoSum(a, b, t2);
+        a = TwoSum(c, t1, t3);
+        b = TwoSum(t2, t3, c);
+    }
+
+    // Same as ThreeSum but only two most significant parts are kept
+    static void ThreeSum2(double& a, double& b, double c)
+    {
+        double t2 = 0.0;
+        double t3 = 0.0;
+        const double t1 = TwoSum(a, b, t2);
+        a = TwoSum(c, t1, t3);
+        b = t2 + t3;
+    }
+
+    // Turns five overlapping components into four non-overlapping ones.
+    // Unlike the QD library there are no special cases for zero components.
+    static void Renormalize(double& c0, double& c1, double& c2, double& c3, double c4)
+    {
+        double s = QuickTwoSum(c3, c4, c4);
+        s = QuickTwoSum(c2, s, c3);
+        s = QuickTwoSum(c1, s, c2);
+        c0 = QuickTwoSum(c0, s, c1);
+
+        c1 = QuickTwoSum(c1, c2, c2);
+        c2 = QuickTwoSum(c2, c3, c3);
+        c3 += c4;
+    }
+
+    QuadDouble& operator+=(const QuadDouble& other)
+    {
+        const auto& a = limbs;
+        const auto& b = other.limbs;
+        double t0 = 0.0;
+        double t1 = 0.0;
+        double t2 = 0.0;
+        double t3 = 0.0;
+
+        double s0 = TwoSum(a[0], b[0], t0);
+        double s1 = TwoSum(a[1], b[1], t1);
+        double s2 = TwoSum(a[2], b[2], t2);
+        double s3 = TwoSum(a[3], b[3], t3);
+
+        s1 = TwoSum(s1, t0, t0);
+        ThreeSum(s2, t0, t1);
+        ThreeSum2(s3, t0, t2);
+        t0 = t0 + t1 + t3;
+
+        Renormalize(s0, s1, s2, s3, t0);
+        limbs = {s0, s1, s2, s3};
+        return *this;
+    }
+
+    QuadDouble& operator-=(const QuadDouble& other)
+    {
+        return *this += -other;
+    }
+
+    QuadDouble& operator*=(const QuadDouble& other)
+    {
+        const auto& a = limbs;
+        const auto& b = other.limbs;
+        double q0 = 0.0;
+        double q1 = 0.0;
+        double q2 = 0.0;
+        double q3 = 0.0;
+        double q4 = 0.0;
+        double q5 = 0.0;
+        double t0 = 0.0;
+        double t1 = 0.0;
+
+        double p0 = TwoProduct(a[0], b[0], q0);
+        double p1 = TwoProduct(a[0], b[1], q1);
+        double p2 = TwoProduct(a[1], b[0], q2);
+        double p3 = TwoProduct(a[0], b[2], q3);
+        double p4 = TwoProduct(a[1], b[1], q4);
+        double p5 = TwoProduct(a[2], b[0], q5);
+
+        ThreeSum(p1, p2, q0);
+
+        // Six-three sum of (p2, q1, q2) and (p3, p4, p5)
+        ThreeSum(p2, q1, q2);
+        ThreeSum(p3, p4, p5);
+        double s0 = TwoSum(p2, p3, t0);
+        double s1 = TwoSum(q1, p4, t1);
+        double s2 = q2 + p5;
+        s1 = TwoSum(s1, t0, t0);
+        s2 += t0 + t1;
+
+        // O(eps^3) terms
+        s1 += a[0] * b[3] + a[1] * b[2] + a[2] * b[1] + a[3] * b[0] + q0 + q3 + q4 + q5;
+
+        Renormalize(p0, p1, s0, s1, s2);
+        limbs = {p0, p1, s0, s1};
+        return *this;
+    }
+
+    QuadDouble& operator/=(const QuadDouble& other)
+    {
+        // Long division with three correction steps
+        const double q0 = limbs[0] / other.limbs[0];
+        QuadDouble r = *this - other * q0;
+        const double q1 = r.limbs[0] / other.limbs[0];
+        r -= other * q1;
+        const double q2 = r.limbs[0] / other.limbs[0];
+        r -= other * q2;
+        const double q3 = r.limbs[0] / other.limbs[0];
+        r -= other * q3;
+        double l0 = q0;
+        double l1 = q1;
+        double l2 = q2;
+        double l3 = q3;
+        Renormalize(l0, l1, l2, l3, r.limbs[0] / other.limbs[0]);
+        limbs = {l0, l1, l2, l3};
+        return *this;
+    }
+
+    friend QuadDouble operator+(QuadDouble a, const QuadDouble& b)
+    {
+        return a += b;
+    }
+
+    friend QuadDouble operator-(QuadDouble a, const QuadDouble& b)
+    {
+        return a -= b;
+    }
+
+    friend QuadDouble operator*(QuadDouble a, const QuadDouble& b)
+    {
+        return a *= b;
+    }
+
+    friend QuadDouble operator/(QuadDouble a, const QuadDouble& b)
+    {
+        return a /= b;
+    }
+
+    // Lexicographic comparison of limbs. Equality is written as <= to keep -Wfloat-equal happy.
+    friend bool operator==(const QuadDouble& a, const QuadDouble& b)
+    {
+        return !(a < b) && !(b < a);
+    }
+
+    friend bool operator<(const QuadDouble& a, const QuadDouble& b)
+    {
+        for (size_t index = 0; index != 3; ++index)
+        {
+            if (a.limbs[index] < b.limbs[index]) return true;
+            if (!(a.limbs[index] <= b.limbs[index])) return false;
+        }
+
+        return a.limbs[3] < b.limbs[3];
+    }
+
+    friend bool operator<=(const QuadDouble& a, const QuadDouble& b)
+    {
+        for (size_t index = 0; index != 3; ++index)
+        {
+            if (a.limbs[index] < b.limbs[index]) return true;
+            if (!(a.limbs[index] <= b.limbs[index])) return false;
+        }
+
+        return a.limbs[3] <= b.limbs[3];
+    }
+
+    friend bool operator>(const QuadDouble& a, const QuadDouble& b)
+    {
+        return b < a;
+    }
+
+    friend bool operator>=(const QuadDouble& a, const QuadDouble& b)
+    {
+        return b <= a;
+    }
+
+    std::array<double, 4> limbs{};
+};
+
+// Lets QuadDouble be used as coordinates (see CoordinateReal)
+template <>
+class std::numeric_limits<QuadDouble>
+{
+public:
+    static constexpr bool is_specialized = true;
+    static constexpr bool is_signed = true;
+    static constexpr bool is_integer = false;
+    static constexpr bool is_exact = false;
+    static constexpr int radix = 2;
+    static constexpr int digits = 4 * std::numeric_limits<double>::digits;
+    static constexpr int digits10 = digits * 301 / 1000;
+
+    static QuadDouble epsilon()
+    {
+        return std::ldexp(1.0, 1 - digits);
+    }
+
+    static QuadDouble max()
+    {
+        return std::numeric_limits<double>::max();
+    }
+
+    static QuadDouble lowest()
+    {
+        return std::numeric_limits<double>::lowest();
+    }
+};
@@ -0,0 +1,267 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <ios>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "float.hpp"
+
+// Number types usable for coordinates (Float). On top of arithmetic they need std::numeric_limits
+// with epsilon() and max(), construction from double and an explicit conversion to double.
+template <typename T>
+concept CoordinateReal = std::numeric_limits<T>::is_specialized && requires(T a, const T b, double d) {
+    T(d);
+    static_cast<double>(b);
+    { b + b } -> std::convertible_to<T>;
+    { b - b } -> std::convertible_to<T>;
+    { b * b } -> std::convertible_to<T>;
+    { b / b } -> std::convertible_to<T>;
+    { -b } -> std::convertible_to<T>;
+    a += b;
+    a -= b;
+    a *= b;
+    a /= b;
+    { b < b } -> std::convertible_to<bool>;
+    { b == b } -> std::convertible_to<bool>;
+};
+
+static_assert(CoordinateReal<Float>, "Float has to satisfy CoordinateReal (see float.hpp)");
+
+template <typename T>
+inline constexpr bool kIsMultiprecisionNumber = false;
+
+template <typename Backend, boost::multiprecision::expression_template_option kExpressionTemplates>
+inline constexpr bool kIsMultiprecisionNumber<boost::multiprecision::number<Backend, kExpressionTemplates>> = true;
+
+// Doubles it takes to convert the widest MultiFloat as a sum of doubles (log2(10) ~ 3.32 bits per digit)
+inline constexpr size_t kMaxRealCastTerms =
+    kMultiFloatDigits.back() * 332 / 100 / static_cast<unsigned>(std::numeric_limits<double>::digits) + 2;
+
+// Rounds a number to another number type: a precision tier, MultiFloat or a coordinate type.
+// Types without a conversion between them are converted as a sum of doubles, which is exact
+// for double-double, quad-double and fixed point.
+template <typename T, typename From>
+T RealCast(const From& value)
+{
+    if constexpr (std::is_same_v<T, From>)
+    {
+        return value;
+    }
+    else if constexpr (std::is_arithmetic_v<T>)
+    {
+        return static_cast<T>(static_cast<double>(value));
+    }
+    else if constexpr (kIsMultiprecisionNumber<T> && kIsMultiprecisionNumber<From>)
+    {
+        return T(value);
+    }
+    else if constexpr (requires { T::FromNumber(value); })
+    {
+        return T::FromNumber(value);
+    }
+    else
+    {
+        T result(0.0);
+        From rest = value;
+        for (size_t term = 0; term != kMaxRealCastTerms; ++term)
+        {
+            const auto part = static_cast<double>(rest);
+            if (std::fpclassify(part) == FP_ZERO)
+            {
+                break;
+            }
+
+            result += T(part);
+            rest -= From(part);
+        }
+
+        return result;
+    }
+}
+
+// Operations on coordinates beyond arithmetic. boost::multiprecision numbers and floating point types have
+// their own. Other types go through the widest MultiFloat, so their values have to be within the exponent
+// range of double. A custom type that can do better specializes RealTraits.
+template <CoordinateReal Real>
+struct RealTraits
+{
+    using Wide = MultiFloat<kMultiFloatDigits.back()>;
+
+    // Parses a decimal number, throws std::runtime_error if the text is not one or Real can't hold it
+    static Real FromString(const std::string& text)
+    {
+        if constexpr (kIsMultiprecisionNumber<Real>)
+        {
+            return Real(text);
+        }
+        else
+        {
+            const Wide value(text);
+            if (boost::multiprecision::abs(value) > Wide(static_cast<double>(std::numeric_limits<Real>::max())))
+            {
+                throw std::runtime_error("The number is out of the coordinate range");
+            }
+
+            return RealCast<Real>(value);
+        }
+    }
+
+    // Fixed notation with fraction_digits digits after the point
+    static std::string ToString(const Real& value, std::streamsize fraction_digits)
+    {
+        if constexpr (kIsMultiprecisionNumber<Real>)
+        {
+            return value.str(fraction_digits, std::ios_base::fixed);
+        }
+        else
+        {
+            return RealCast<Wide>(value).str(fraction_digits, std::ios_base::fixed);
+        }
+    }
+
+    // Exact for values up to 2^63
+    static Real FromInteger(int64_t value)
+    {
+        if constexpr (kIsMultiprecisionNumber<Real>)
+        {
+            return Real(value);
+        }
+        else
+        {
+            constexpr int64_t kExactInDouble = int64_t{1} << std::numeric_limits<double>::digits;
+            if (value > -kExactInDouble && value < kExactInDouble)
+            {
+                return Real(static_cast<double>(value));
+            }
+
+            constexpr double kLowRange = 4294967296.0;
+            return Real(static_cast<double>(value >> 32)) * Real(kLowRange) +
+                   Real(static_cast<double>(value & 0xffffffff));
+        }
+    }
+
+    // Truncates towards zero, the value has to fit into int64_t
+    static int64_t ToInteger(const Real& value)
+    {
+        if constexpr (kIsMultiprecisionNumber<Real> || std::is_floating_point_v<Real>)
+        {
+            return static_cast<int64_t>(value);
+        }
+        else
+        {
+            return static_cast<int64_t>(RealCast<Wide>(value));
+        }
+    }
+
+    static Real Abs(const Real& value)
+    {
+        return value < Real(0) ? Real(-value) : value;
+    }
+
+    static Real Floor(const Real& value)
+    {
+        if constexpr (kIsMultiprecisionNumber<Real>)
+        {
+            return Real(boost::multiprecision::floor(value));
+        }
+        else if constexpr (std::is_floating_point_v<Real>)
+        {
+            return std::floor(value);
+        }
+        else
+        {
+            return RealCast<Real>(Wide(boost::multiprecision::floor(RealCast<Wide>(value))));
+        }
+    }
+
+    // Halfway cases are rounded away from zero
+    static Real Round(const Real& value)
+    {
+        if constexpr (kIsMultiprecisionNumber<Real>)
+        {
+            return Real(boost::multiprecision::round(value));
+        }
+        else if constexpr (std::is_floating_point_v<Real>)
+        {
+            return std::round(value);
+        }
+        else
+        {
+            return RealCast<Real>(Wide(boost::multiprecision::round(RealCast<Wide>(value))));
+        }
+    }
+
+    static Real Pow(const Real& base, unsigned exponent)
+    {
+        if constexpr (kIsMultiprecisionNumber<Real>)
+        {
+            return Real(boost::multiprecision::pow(base, exponent));
+        }
+        else
+        {
+            Real result(1);
+            Real power = base;
+            for (; exponent != 0; exponent /= 2)
+            {
+                if (exponent % 2 != 0)
+                {
+                    result *= power;
+                }
+
+                power *= power;
+            }
+
+            return result;
+        }
+    }
+
+    // value * 2^exponent, exact for binary types
+    static Real Ldexp(const Real& value, int exponent)
+    {
+        if constexpr (kIsMultiprecisionNumber<Real>)
+        {
+            return Real(boost::multiprecision::ldexp(value, exponent));
+        }
+        else if constexpr (std::is_floating_point_v<Real>)
+        {
+            return std::ldexp(value, exponent);
+        }
+        else
+        {
+            // Powers of two beyond the double range are applied in steps
+            constexpr int kMaxStep = 512;
+            Real result = value;
+            while (exponent != 0)
+            {
+                const int step = std::clamp(exponent, -kMaxStep, kMaxStep);
+                result *= Real(std::ldexp(1.0, step));
+                exponent -= step;
+            }
+
+            return result;
+        }
+    }
+
+    // Binary exponent e of value = m * 2^e with 0.5 <= |m| < 1 like frexp
+    static int GetExponent(const Real& value)
+    {
+        int exponent = 0;
+        if constexpr (kIsMultiprecisionNumber<Real>)
+        {
+            boost::multiprecision::frexp(value, &exponent);
+        }
+        else
+        {
+            std::frexp(static_cast<double>(value), &exponent);
+        }
+
+        return exponent;
+    }
+};
@@ -0,0 +1,20 @@
+#include "render_algorithm.hpp"
+
+std::string_view ToString(FractalRenderAlgorithm algorithm)
+{
+    switch (algorithm)
+    {
+    case FractalRenderAlgorithm::BruteForce:
+        return "brute force";
+    case FractalRenderAlgorithm::MarianiSilver:
+        return "Mariani-Silver";
+    case FractalRenderAlgorithm::BoundaryTracing:
+        return "boundary tracing";
+    case FractalRenderAlgorithm::SolidGuessing:
+        return "solid guessing";
+    case FractalRenderAlgorithm::Interleaved:
+        return "interleaved (progressive)";
+    default:
+        return "unknown";
+    }
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// How the CPU backend chooses pixels of a task region to iterate
+enum class FractalRenderAlgorithm : uint8_t
+{
+    // Every pixel is iterated
+    BruteForce,
+    // Rectangles with a uniform border are filled without iterating the inside
+    MarianiSilver,
+    // Contours of escape bands are traced and their insides are filled.
+    // Islands of a band that no contour reaches are filled over.
+    BoundaryTracing,
+    // Coarse grid is refined where neighbour samples differ, the rest is guessed
+    SolidGuessing,
+    // Every pixel is iterated in Adam7 passes and partial regions are displayed at coarse resolution
+    Interleaved
+};
+
+inline constexpr size_t kFractalRenderAlgorithmCount = 5;
+
+std::string_view ToString(FractalRenderAlgorithm algorithm);
@@ -1,180 +1,364 @@
 #include "rendering_backend_cpu.hpp"
 
+#include <algorithm>
 #include <cassert>
-
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <ranges>
+#include <thread>
+
+#include "fmt/format.h"
+#include "interleaved_fill.hpp"
 #include "klgl/application.hpp"
 #include "klgl/mesh/mesh_data.hpp"
 #include "klgl/shader/shader.hpp"
 #include "klgl/texture/texture.hpp"
 #include "klgl/window.hpp"
-#include "mandelbrot.hpp"
 #include "mesh_vertex.hpp"
+#include "perturbation.hpp"
+#include "real_traits.hpp"
 
-FractalCPURenderingThread::FractalCPURenderingThread(boost::lockfree::queue<ThreadTask*>& task_queue)
-    : task_queue_(task_queue)
+FractalRenderingBackendCPU::FractalRenderingBackendCPU(
+    klgl::Application& app,
+    FractalSettings& settings,
+    FractalCPUWorkerPool& workers)
+    : app_(app),
+      settings_(settings),
+      workers_(workers),
+      tile_cache_(static_cast<size_t>(settings.tile_cache_budget_mb) << 20)
 {
-    thread_ = std::thread(&FractalCPURenderingThread::thread_main, this);
+    render_texture_shader = std::make_unique<klgl::Shader>("just_texture.shader.json");
+    texture_loc = render_texture_shader->GetUniform("uTexture");
+
+    const std::array<MeshVertex, 4> vertices{
+        {{.position = {1.0f, 1.0f}, .tex_coord = {1.0f, 1.0f}},
+         {.position = {1.0f, -1.0f}, .tex_coord = {1.0f, 0.0f}},
+         {.position = {-1.0f, -1.0f}, .tex_coord = {0.0f, 0.0f}},
+         {.position = {-1.0f, 1.0f}, .tex_coord = {0.0f, 1.0f}}}};
+    const std::array<uint32_t, 6> indices{0, 1, 3, 1, 2, 3};
+
+    // Make mesh
+    quad_mesh = klgl::MeshOpenGL::MakeFromData<MeshVertex>(std::span{vertices}, std::span{indices});
+    quad_mesh->Bind();
+    RegisterAttribute<&MeshVertex::position>(0, false);
+    RegisterAttribute<&MeshVertex::tex_coord>(1, false);
+
+    CreateTexture();
+    frame_iterations_.assign(texture->GetSize().prod(), kNotComputed);
+    UpdatePalette(settings_.max_iterations);
 }
 
-FractalCPURenderingThread::~FractalCPURenderingThread()
+FractalRenderingBackendCPU::~FractalRenderingBackendCPU()
 {
-    must_stop_ = true;
-    thread_.join();
+    // Workers outlive the backend so started tasks are stopped early and awaited
+    CancelAllTasks();
+    for (auto& task : tasks_)
+    {
+        while (!task->completed)
+        {
+            std::this_thread::yield();
+        }
+    }
 }
 
-Eigen::Vector3<uint8_t> FractalCPURenderingThread::ColorForIteration(ThreadTask& task, size_t iteration)
+void FractalRenderingBackendCPU::Draw()
 {
-    if (iteration == task.iterations) return {0, 0, 0};
-
-    const size_t segments_count = task.colors.size() - 1;
-    const size_t iterations_per_segment = task.iterations / segments_count;
-    const size_t k = iteration * segments_count;
-    const size_t first_color_index = k / task.iterations;
-    auto color_a = task.colors[first_color_index].cast<float>();
-    auto color_b = task.colors[first_color_index + 1].cast<float>();
-    const float p = static_cast<float>(k % iterations_per_segment) / static_cast<float>(iterations_per_segment);
-    return (color_a + (color_b - color_a) * p).cast<uint8_t>();
+    texture->Bind();
+
+    // New palette recolors the whole texture once, completed regions included
+    const bool recolor = !settings_.colors_applied;
+    if (recolor)
+    {
+        UpdatePalette(palette_->GetMaxIterations());
+    }
+
+    DisplayReadyTasks(!recolor);
+    DisplayTasksInProgress();
+
+    if (recolor)
+    {
+        UploadRegion({0, 0}, {texture->GetWidth(), texture->GetHeight()});
+    }
+
+    render_texture_shader->Use();
+    render_texture_shader->SetUniform(texture_loc, *texture);
+    render_texture_shader->SendUniforms();
+    quad_mesh->Bind();
+    quad_mesh->Draw();
 }
 
-using FractalFunction = size_t (*)(const Float& x, const Float& y, size_t iterations);
+// Workers may still use the previous palette so a new one is created every time
+void FractalRenderingBackendCPU::UpdatePalette(uint32_t max_iterations)
+{
+    auto palette = std::make_shared<PaletteLut>();
+    palette->Build(settings_.colors, max_iterations);
+    palette_ = std::move(palette);
+    settings_.colors_applied = true;
+}
 
-static FractalFunction SelectFractalFunction(bool use_double)
+void FractalRenderingBackendCPU::DisplayReadyTasks(bool upload)
 {
-    if (use_double)
+    while (!ready_for_display_.empty())
     {
-        return [](const Float& x, const Float& y, const size_t iterations)
+        auto task = std::move(ready_for_display_.back());
+        ready_for_display_.pop_back();
+
+        if (task->tile)
         {
-            return MandelbrotLoop<double>(static_cast<double>(x), static_cast<double>(y), iterations);
-        };
-    }
-    else
-    {
-        return [](const Float& x, const Float& y, const size_t iterations)
+            const auto covered = ResampleTile(*task->tile, task->pixels_iterations);
+            StoreTile(*task);
+            if (covered && upload)
+            {
+                UploadRegion(covered->first, covered->second);
+            }
+            continue;
+        }
+
+        StoreIterations(*task);
+        if (!upload)
+        {
+            continue;
+        }
+
+        // Colors of the task are stale if the palette changed while it was in progress
+        if (task->palette == palette_)
+        {
+            texture->UploadRegion<uint32_t>(task->region_screen_location, task->region_screen_size, task->pixels_rgba);
+        }
+        else
         {
-            return MandelbrotLoop<Float>(x, y, iterations);
-        };
+            UploadRegion(task->region_screen_location, task->region_screen_size);
+        }
     }
 }
 
-void FractalCPURenderingThread::do_task(ThreadTask& task)
+void FractalRenderingBackendCPU::DisplayTasksInProgress()
 {
-    auto start_time = std::chrono::high_resolution_clock::now();
-    task.pixels_iterations.resize(task.region_screen_size.prod());
-    const auto ff = SelectFractalFunction(task.use_double);
-    for (size_t y = 0; y != task.region_screen_size.y(); ++y)
+    for (auto& task : tasks_)
     {
-        task.rows_completed = static_cast<uint16_t>(y);
+        const bool interleaved = task->algorithm == FractalRenderAlgorithm::Interleaved;
+        const bool solid_guessing = task->algorithm == FractalRenderAlgorithm::SolidGuessing;
+        if (!(interleaved || solid_guessing) || task->tile || task->completed || task->IsCancelled())
+        {
+            continue;
+        }
 
-        if (task.cancelled)
+        // Pixels of completed passes are not written anymore
+        const uint8_t passes = task->passes_completed.load(std::memory_order_acquire);
+        if (passes == task->passes_displayed)
         {
-            break;
+            continue;
         }
 
-        Float py = task.world_start_point.y() + task.world_step_per_pixel.y() * y;
-        for (size_t x = 0; x != task.region_screen_size.x(); ++x)
+        task->passes_displayed = passes;
+        const PixelIndex step =
+            interleaved ? GetInterleavedPreviewStep(passes) : task->solid_guessing.GetPreviewStep(passes);
+        const size_t width = task->region_screen_size.x();
+        const size_t height = task->region_screen_size.y();
+        preview_iterations_.resize(width * height);
+        for (size_t y = 0; y != height; ++y)
         {
-            Float px = task.world_start_point.x() + task.world_step_per_pixel.x() * x;
-            const auto iterations = static_cast<uint16_t>(ff(px, py, 1000));
-            task.pixels_iterations[y * task.region_screen_size.x() + x] = iterations;
+            const size_t source_row = (y - y % step.y) * width;
+            for (size_t x = 0; x != width; ++x)
+            {
+                preview_iterations_[y * width + x] = task->pixels_iterations[source_row + x - x % step.x];
+            }
         }
+
+        upload_pixels_.resize(preview_iterations_.size());
+        palette_->Colorize(preview_iterations_, upload_pixels_);
+        texture->UploadRegion<uint32_t>(task->region_screen_location, task->region_screen_size, upload_pixels_);
     }
+}
 
-    auto end_time = std::chrono::high_resolution_clock::now();
-    task.task_duration_seconds =
-        std::chrono::duration_cast<std::chrono::duration<float>>(end_time - start_time).count();
-    task.completed = true;
+void FractalRenderingBackendCPU::StoreIterations(const ThreadTask& task)
+{
+    const size_t frame_width = texture->GetWidth();
+    const size_t width = task.region_screen_size.x();
+    const auto& location = task.region_screen_location;
+    for (size_t y = 0; y != task.region_screen_size.y(); ++y)
+    {
+        const size_t frame_offset = (location.y() + y) * frame_width + location.x();
+        std::ranges::copy(
+            std::span{task.pixels_iterations}.subspan(y * width, width),
+            std::span{frame_iterations_}.subspan(frame_offset).begin());
+    }
 }
 
-void FractalCPURenderingThread::thread_main()
+void FractalRenderingBackendCPU::UploadRegion(
+    const Eigen::Vector2<size_t>& location,
+    const Eigen::Vector2<size_t>& size)
 {
-    while (!must_stop_)
+    const size_t frame_width = texture->GetWidth();
+    upload_pixels_.resize(size.prod());
+    for (size_t y = 0; y != size.y(); ++y)
     {
-        ThreadTask* task = nullptr;
-        if (task_queue_.pop(task))
-        {
-            do_task(*task);
-        }
+        const size_t frame_offset = (location.y() + y) * frame_width + location.x();
+        palette_->Colorize(
+            std::span{frame_iterations_}.subspan(frame_offset, size.x()),
+            std::span{upload_pixels_}.subspan(y * size.x(), size.x()));
     }
+
+    texture->UploadRegion<uint32_t>(location, size, upload_pixels_);
 }
 
-FractalRenderingBackendCPU::FractalRenderingBackendCPU(klgl::Application& app, FractalSettings& settings)
-    : app_(app),
-      settings_(settings),
-      task_queue_(200)
+// prioritize tasks that closer to the center of texture
+static void SortByDistanceToCenter(
+    std::vector<std::unique_ptr<ThreadTask>>& tasks,
+    const Eigen::Vector2<size_t>& screen_size)
 {
-    render_texture_shader = std::make_unique<klgl::Shader>("just_texture.shader.json");
-    texture_loc = render_texture_shader->GetUniform("uTexture");
+    std::ranges::sort(
+        tasks,
+        [&](const std::unique_ptr<ThreadTask>& a, const std::unique_ptr<ThreadTask>& b)
+        {
+            Eigen::Vector2i dist_a = a->region_screen_location.cast<int>() - (screen_size / 2).cast<int>();
+            Eigen::Vector2i dist_b = b->region_screen_location.cast<int>() - (screen_size / 2).cast<int>();
+            return dist_a.squaredNorm() < dist_b.squaredNorm();
+        });
+}
 
-    const std::array<MeshVertex, 4> vertices{
-        {{.position = {1.0f, 1.0f}, .tex_coord = {1.0f, 1.0f}},
-         {.position = {1.0f, -1.0f}, .tex_coord = {1.0f, 0.0f}},
-         {.position = {-1.0f, -1.0f}, .tex_coord = {0.0f, 0.0f}},
-         {.position = {-1.0f, 1.0f}, .tex_coord = {0.0f, 1.0f}}}};
-    const std::array<uint32_t, 6> indices{0, 1, 3, 1, 2, 3};
+// Tile pixel size of the level
+static Float GetTileStep(int level)
+{
+    return RealTraits<Float>::Ldexp(Float(1), -5 - level);
+}
 
-    // Make mesh
-    quad_mesh = klgl::MeshOpenGL::MakeFromData<MeshVertex>(std::span{vertices}, std::span{indices});
-    quad_mesh->Bind();
-    RegisterAttribute<&MeshVertex::position>(0, false);
-    RegisterAttribute<&MeshVertex::tex_coord>(1, false);
+// Largest quotient divided out of coordinates: tile indices are converted to int64_t and
+// narrow coordinate types (fixed point) can't hold much more than a few thousand
+static const Float kMaxQuotient =
+    Float(std::min(std::ldexp(1.0, 60), static_cast<double>(std::numeric_limits<Float>::max()) / 4));
 
-    CreateTexture();
-    workers_.resize(10);
+// Floor of value / divisor or nothing if it exceeds kMaxQuotient. Checked before dividing so the quotient fits Float
+static std::optional<int64_t> FloorDivide(const Float& value, const Float& divisor)
+{
+    if (!(RealTraits<Float>::Abs(value) < kMaxQuotient * divisor))
+    {
+        return std::nullopt;
+    }
+
+    return RealTraits<Float>::ToInteger(RealTraits<Float>::Floor(value / divisor));
+}
 
-    for (auto& region : workers_)
+// Offset in whole pixels between two frame origins or nothing if the offset is fractional
+static std::optional<std::array<ptrdiff_t, 2>>
+GetPixelShift(const Vector2f& from, const Vector2f& to, const Vector2f& step)
+{
+    // Far shifts overlap nothing, they are clamped before dividing
+    constexpr ptrdiff_t kFar = 1'000'000'000;
+    static const Float kFarPixels = std::min(kMaxQuotient, Float(static_cast<double>(kFar)));
+
+    std::array<ptrdiff_t, 2> shift{};
+    for (size_t index = 0; index != shift.size(); ++index)
     {
-        if (!region)
+        const Float difference = to[index] - from[index];
+        if (!(RealTraits<Float>::Abs(difference) < kFarPixels * step[index]))
+        {
+            shift[index] = difference < Float(0) ? -kFar : kFar;
+            continue;
+        }
+
+        const Float pixels = difference / step[index];
+        const Float rounded = RealTraits<Float>::Round(pixels);
+        if (RealTraits<Float>::Abs(pixels - rounded) > Float(1e-3))
         {
-            region = std::make_unique<FractalCPURenderingThread>(task_queue_);
+            return std::nullopt;
         }
+
+        shift[index] = static_cast<ptrdiff_t>(RealTraits<Float>::ToInteger(rounded));
     }
+
+    return shift;
 }
 
-FractalRenderingBackendCPU::~FractalRenderingBackendCPU()
+void FractalRenderingBackendCPU::ShiftIterations(
+    const Eigen::Vector2<size_t>& old_size,
+    const Eigen::Vector2<size_t>& size,
+    const std::optional<std::array<ptrdiff_t, 2>>& shift)
 {
-    CancelAllTasks();
+    std::vector<uint32_t> shifted(size.prod(), kNotComputed);
+    if (shift)
+    {
+        // Pixel (x, y) of the new frame is pixel (x + shift_x, y + shift_y) of the old one
+        const auto [shift_x, shift_y] = *shift;
+        const auto width = static_cast<ptrdiff_t>(size.x());
+        const auto old_width = static_cast<ptrdiff_t>(old_size.x());
+        const ptrdiff_t x_begin = std::max<ptrdiff_t>(0, -shift_x);
+        const ptrdiff_t x_end = std::min(width, old_width - shift_x);
+        for (ptrdiff_t y = 0; y != static_cast<ptrdiff_t>(size.y()); ++y)
+        {
+            const ptrdiff_t old_y = y + shift_y;
+            if (old_y < 0 || old_y >= static_cast<ptrdiff_t>(old_size.y()) || x_begin >= x_end)
+            {
+                continue;
+            }
+
+            const auto source = frame_iterations_.begin() + old_y * old_width + x_begin + shift_x;
+            std::copy(source, source + (x_end - x_begin), shifted.begin() + y * width + x_begin);
+        }
+    }
+
+    frame_iterations_ = std::move(shifted);
 }
 
-void FractalRenderingBackendCPU::Draw()
+// Bounding box of pixels of the region that are not computed yet
+std::optional<std::pair<Eigen::Vector2<size_t>, Eigen::Vector2<size_t>>> FractalRenderingBackendCPU::FindMissingPixels(
+    const Eigen::Vector2<size_t>& location,
+    const Eigen::Vector2<size_t>& size) const
 {
-    texture->Bind();
-
-    while (!ready_for_display_.empty())
+    const size_t frame_width = texture->GetWidth();
+    size_t min_x = size.x();
+    size_t max_x = 0;
+    size_t min_y = size.y();
+    size_t max_y = 0;
+    for (size_t y = 0; y != size.y(); ++y)
     {
-        auto task = std::move(ready_for_display_.back());
-        ready_for_display_.pop_back();
-
-        std::vector<Eigen::Vector3<uint8_t>> pixels;
-        pixels.reserve(task->pixels_iterations.size());
-        for (uint16_t iterations : task->pixels_iterations)
+        const size_t row_offset = (location.y() + y) * frame_width + location.x();
+        const auto row = std::span{frame_iterations_}.subspan(row_offset, size.x());
+        const auto first = std::ranges::find(row, kNotComputed);
+        if (first == row.end())
         {
-            pixels.emplace_back(FractalCPURenderingThread::ColorForIteration(*task, iterations));
+            continue;
         }
 
-        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-        glTexSubImage2D(
-            GL_TEXTURE_2D,
-            0,
-            static_cast<GLint>(task->region_screen_location.x()),
-            static_cast<GLint>(task->region_screen_location.y()),
-            static_cast<GLsizei>(task->region_screen_size.x()),
-            static_cast<GLsizei>(task->region_screen_size.y()),
-            GL_RGB,
-            GL_UNSIGNED_BYTE,
-            pixels.data());
+        const auto last = std::ranges::find(std::views::reverse(row), kNotComputed);
+        min_x = std::min(min_x, static_cast<size_t>(first - row.begin()));
+        max_x = std::max(max_x, static_cast<size_t>(row.rend() - last) - 1);
+        min_y = std::min(min_y, y);
+        max_y = y;
     }
 
-    render_texture_shader->Use();
-    render_texture_shader->SetUniform(texture_loc, *texture);
-    render_texture_shader->SendUniforms();
-    quad_mesh->Bind();
-    quad_mesh->Draw();
+    if (min_y == size.y())
+    {
+        return std::nullopt;
+    }
+
+    return std::pair{
+        Eigen::Vector2<size_t>{location.x() + min_x, location.y() + min_y},
+        Eigen::Vector2<size_t>{max_x - min_x + 1, max_y - min_y + 1}};
+}
+
+void FractalRenderingBackendCPU::StoreTile(ThreadTask& task)
+{
+    // The store is append-only, a partial tile would never be computed again
+    if (!task.IsFullyComputed())
+    {
+        return;
+    }
+
+    if (tile_store_)
+    {
+        tile_store_->Append(*task.tile, task.pixels_iterations);
+    }
+
+    tile_cache_.Insert(*task.tile, std::move(task.pixels_iterations));
 }
 
 void FractalRenderingBackendCPU::CancelAllTasks()
 {
-    task_queue_.consume_all(
-        [&](auto& task)
+    ++frame_epoch_;
+    workers_.ConsumeAll(
+        [&](ThreadTask* task)
         {
             task->cancelled = true;
             task->completed = true;
@@ -188,11 +372,18 @@ void FractalRenderingBackendCPU::HandleCompletedTasks()
     {
         if (task->completed)
         {
-            if (!task->cancelled)
+            if (!task->IsCancelled() && !task->speculative)
             {
                 *current_frame_duration_ += task->task_duration_seconds;
+                current_frame_stats_ += task->stats;
                 ready_for_display_.emplace_back(std::move(task));
             }
+            else if (task->tile && !task->cancelled && task->IsFullyComputed())
+            {
+                // Speculative tiles and tiles of a changed frame are complete and may be needed later
+                speculative_tiles_computed_ += task->speculative ? 1u : 0u;
+                StoreTile(*task);
+            }
             task = nullptr;
         }
     }
@@ -210,14 +401,11 @@ void FractalRenderingBackendCPU::HandleCompletedTasks()
 
 bool FractalRenderingBackendCPU::HasTasksInProgress() const
 {
-    if (!task_queue_.empty())
-    {
-        return true;
-    }
-
+    // Tasks of cancelled frames are still winding down, but the current frame does not wait for them.
+    // Speculative tiles are not part of the frame.
     for (auto& task : tasks_)
     {
-        if (!task->completed)
+        if (!task->completed && task->epoch == frame_epoch_ && !task->speculative)
         {
             return true;
         }
@@ -228,9 +416,15 @@ bool FractalRenderingBackendCPU::HasTasksInProgress() const
 
 void FractalRenderingBackendCPU::StartNewFractalFrame()
 {
-    assert(task_queue_.empty());
+    assert(!workers_.HasQueuedTasks());
+
+    UpdateTileStore();
+
+    // Regions of the previous frame must reach the retained iterations before they are shifted
+    DisplayReadyTasks(true);
 
     // Recreate texture to match window size
+    const Eigen::Vector2<size_t> old_size = texture->GetSize();
     CreateTexture();
 
     auto get_part = [](size_t full_size, size_t parts_count, size_t part_index)
@@ -244,6 +438,90 @@ void FractalRenderingBackendCPU::StartNewFractalFrame()
         return min_part;
     };
 
+    const Vector2f& step = settings_.GetStepPerPixel();
+    precision_choice_ = ChoosePrecision(step.x() > step.y() ? step.x() : step.y());
+    if (!settings_.auto_precision)
+    {
+        precision_choice_.precision = settings_.precision;
+    }
+
+    if (palette_->GetMaxIterations() != settings_.max_iterations)
+    {
+        UpdatePalette(settings_.max_iterations);
+    }
+
+    // Direction of the last zoom and pan predicts the views to compute speculatively
+    const Vector2f& camera = settings_.GetCamera();
+    if (last_step_)
+    {
+        if (step.x() != last_step_->x())
+        {
+            zoom_direction_ = step.x() < last_step_->x() ? 1 : -1;
+            pan_direction_ = {};
+        }
+        else
+        {
+            for (size_t axis = 0; axis != 2; ++axis)
+            {
+                if (camera[axis] != last_camera_[axis])
+                {
+                    pan_direction_[axis] = camera[axis] > last_camera_[axis] ? 1 : -1;
+                }
+            }
+        }
+    }
+    last_step_ = step;
+    last_camera_ = camera;
+    speculation_queued_ = false;
+
+    tiled_frame_ = std::nullopt;
+    if (settings_.use_tile_cache && !settings_.use_perturbation && StartTiledFrame())
+    {
+        return;
+    }
+
+    // Same key and a pixel aligned origin (pan with keys, resize along the longer side) keep
+    // the overlapping iterations so only the exposed pixels are computed
+    const FrameKey frame_key{
+        .step = step,
+        .max_iterations = settings_.max_iterations,
+        .precision = precision_choice_.precision,
+        .multiprecision_digits = precision_choice_.digits,
+        .algorithm = settings_.render_algorithm,
+        .solid_guessing = SolidGuessingOptions::FromAggressiveness(
+            settings_.solid_guessing_aggressiveness,
+            settings_.verify_solid_guessing),
+        .perturbation = settings_.use_perturbation,
+        .series_approximation = settings_.use_series_approximation};
+    const Vector2f frame_origin = settings_.GetCoordAtPixel(0, 0);
+    std::optional<std::array<ptrdiff_t, 2>> shift;
+    if (frame_key_ == frame_key)
+    {
+        shift = GetPixelShift(frame_origin_, frame_origin, step);
+    }
+
+    ShiftIterations(old_size, texture->GetSize(), shift);
+    frame_key_ = frame_key;
+    frame_origin_ = frame_origin;
+    if (shift)
+    {
+        UploadRegion({0, 0}, texture->GetSize());
+    }
+
+    perturbation_frame_ = nullptr;
+    if (settings_.use_perturbation)
+    {
+        const Vector2f& range = settings_.GetCoordRange();
+        ReferenceOrbit::Parameters params{
+            .center = settings_.GetCamera(),
+            .max_iterations = settings_.max_iterations,
+            .max_delta = 0.5 * std::hypot(static_cast<double>(range.x()), static_cast<double>(range.y())),
+            .pixel_size = std::max(static_cast<double>(step.x()), static_cast<double>(step.y())),
+            .use_series_approximation = settings_.use_series_approximation,
+            .digits = precision_choice_.digits};
+        perturbation_frame_ = std::make_shared<PerturbationFrame>(params);
+    }
+
     std::vector<std::unique_ptr<ThreadTask>> temp_tasks_;
 
     size_t location_y = 0;
@@ -254,22 +532,23 @@ void FractalRenderingBackendCPU::StartNewFractalFrame()
         for (size_t rx = 0; rx != kChunkHeight; ++rx)
         {
             const size_t region_width = get_part(texture->GetWidth(), kChunkHeight, rx);
-            const Eigen::Vector2<size_t> region_screen_location{location_x, location_y};
-            const Eigen::Vector2<size_t> region_screen_size{region_width, region_height};
-
+            const auto missing = FindMissingPixels({location_x, location_y}, {region_width, region_height});
+            if (missing)
             {
+                const auto& [region_screen_location, region_screen_size] = *missing;
                 auto task = std::make_unique<ThreadTask>();
-                task->iterations = 1000;
-                task->use_double = settings_.use_double;
-                task->colors.clear();
-                task->world_start_point = settings_.GetCoordAtPixel(location_x, location_y);
+                task->iterations = settings_.max_iterations;
+                task->precision = precision_choice_.precision;
+                task->multiprecision_digits = precision_choice_.digits;
+                task->algorithm = settings_.render_algorithm;
+                task->solid_guessing = frame_key.solid_guessing;
+                task->perturbation = perturbation_frame_;
+                task->palette = palette_;
+                task->world_start_point =
+                    settings_.GetCoordAtPixel(region_screen_location.x(), region_screen_location.y());
                 task->world_step_per_pixel = settings_.GetStepPerPixel();
                 task->region_screen_location = region_screen_location;
                 task->region_screen_size = region_screen_size;
-                for (auto& color : settings_.colors)
-                {
-                    task->colors.push_back((color * 255.f).cast<uint8_t>());
-                }
 
                 temp_tasks_.push_back(std::move(task));
             }
@@ -279,23 +558,371 @@ void FractalRenderingBackendCPU::StartNewFractalFrame()
         location_y += region_height;
     }
 
-    // prioritize tasks that closer to the center of texture
-    std::ranges::sort(
-        temp_tasks_,
-        [&](const std::unique_ptr<ThreadTask>& a, const std::unique_ptr<ThreadTask>& b)
+    SortByDistanceToCenter(temp_tasks_, texture->GetSize());
+    QueueTasks(std::move(temp_tasks_));
+}
+
+bool FractalRenderingBackendCPU::StartTiledFrame()
+{
+    // Tile pixel of level L is 2^(-5 - L). The screen pixel is in [2^(e - 1), 2^e) where e is
+    // pixel_exponent, so the tile pixel 2^(e - 1) is at most the screen pixel and more than a half of it.
+    const int level = -4 - precision_choice_.pixel_exponent;
+    const Eigen::Vector2<size_t> size = texture->GetSize();
+    if (level < 0 || level > kMaxTileLevel || size.x() == 0 || size.y() == 0)
+    {
+        return false;
+    }
+
+    const Vector2f origin = settings_.GetCoordAtPixel(0, 0);
+    const Vector2f& step = settings_.GetStepPerPixel();
+    const Float tile_step = GetTileStep(level);
+    const Float tile_world_size = tile_step * Float(static_cast<double>(TileCache::kTileSize));
+    constexpr auto kTileSize = static_cast<int64_t>(TileCache::kTileSize);
+
+    TiledFrame frame;
+    frame.level = level;
+    std::array<int64_t*, 2> first_tile{&frame.first_tile_x, &frame.first_tile_y};
+    std::array<std::vector<int64_t>*, 2> axis_samples{&frame.columns, &frame.rows};
+    for (size_t axis = 0; axis != 2; ++axis)
+    {
+        const std::optional<int64_t> first = FloorDivide(origin[axis], tile_world_size);
+        if (!first)
         {
-            const auto screeni = texture->GetSize();
-            Eigen::Vector2i dist_a = a->region_screen_location.cast<int>() - (screeni / 2).cast<int>();
-            Eigen::Vector2i dist_b = b->region_screen_location.cast<int>() - (screeni / 2).cast<int>();
-            return dist_a.squaredNorm() < dist_b.squaredNorm();
-        });
+            return false;
+        }
+
+        // Both are measured in tile pixels and are small enough for double
+        const Float first_start = RealTraits<Float>::FromInteger(*first) * tile_world_size;
+        const auto offset = static_cast<double>((origin[axis] - first_start) / tile_step);
+        const auto ratio = static_cast<double>(step[axis] / tile_step);
+        *first_tile[axis] = *first;
+        std::vector<int64_t>& samples = *axis_samples[axis];
+        samples.resize(size[static_cast<Eigen::Index>(axis)]);
+        for (size_t index = 0; index != samples.size(); ++index)
+        {
+            samples[index] = static_cast<int64_t>(std::floor(offset + ratio * static_cast<double>(index)));
+        }
+    }
+
+    tiled_frame_ = std::move(frame);
+    frame_key_ = std::nullopt;
+    perturbation_frame_ = nullptr;
+    frame_iterations_.assign(size.prod(), kNotComputed);
+
+    // Screen pixel where the tile starts, only used to order tasks
+    auto get_screen_location = [](const std::vector<int64_t>& samples, int64_t tile_index)
+    {
+        const auto it = std::ranges::lower_bound(samples, tile_index * kTileSize);
+        return std::min(static_cast<size_t>(it - samples.begin()), samples.size() - 1);
+    };
+
+    std::vector<std::unique_ptr<ThreadTask>> tasks;
+    TileKey key = MakeTileKey(level);
+    const int64_t tiles_x = tiled_frame_->columns.back() / kTileSize + 1;
+    const int64_t tiles_y = tiled_frame_->rows.back() / kTileSize + 1;
+    for (int64_t tile_y = 0; tile_y != tiles_y; ++tile_y)
+    {
+        for (int64_t tile_x = 0; tile_x != tiles_x; ++tile_x)
+        {
+            key.x = tiled_frame_->first_tile_x + tile_x;
+            key.y = tiled_frame_->first_tile_y + tile_y;
+            if (const auto iterations = FindTile(key))
+            {
+                ResampleTile(key, *iterations);
+                continue;
+            }
+
+            auto task = MakeTileTask(key);
+            task->region_screen_location = {
+                get_screen_location(tiled_frame_->columns, tile_x),
+                get_screen_location(tiled_frame_->rows, tile_y)};
+            tasks.push_back(std::move(task));
+        }
+    }
+
+    UploadRegion({0, 0}, size);
+    SortByDistanceToCenter(tasks, size);
+    QueueTasks(std::move(tasks));
+    return true;
+}
+
+TileKey FractalRenderingBackendCPU::MakeTileKey(int level) const
+{
+    PrecisionChoice tile_precision = ChoosePrecision(GetTileStep(level));
+    if (!settings_.auto_precision)
+    {
+        tile_precision.precision = settings_.precision;
+    }
+
+    return TileKey{
+        .level = level,
+        .max_iterations = settings_.max_iterations,
+        .precision = tile_precision.precision,
+        .multiprecision_digits = tile_precision.digits,
+        .algorithm = settings_.render_algorithm,
+        .solid_guessing = SolidGuessingOptions::FromAggressiveness(
+            settings_.solid_guessing_aggressiveness,
+            settings_.verify_solid_guessing)};
+}
+
+std::optional<std::span<const uint32_t>> FractalRenderingBackendCPU::FindTile(const TileKey& key)
+{
+    if (const std::vector<uint32_t>* iterations = tile_cache_.Find(key))
+    {
+        return *iterations;
+    }
+
+    const auto stored = tile_store_ ? tile_store_->Find(key) : std::nullopt;
+    if (stored)
+    {
+        tile_cache_.Insert(key, std::vector<uint32_t>(stored->begin(), stored->end()));
+    }
+
+    return stored;
+}
 
-    for (auto& task : temp_tasks_)
+bool FractalRenderingBackendCPU::HasTile(const TileKey& key)
+{
+    return tile_cache_.Contains(key) || (tile_store_ && tile_store_->Contains(key));
+}
+
+std::unique_ptr<ThreadTask> FractalRenderingBackendCPU::MakeTileTask(const TileKey& key) const
+{
+    const Float tile_step = GetTileStep(key.level);
+    const Float tile_world_size = tile_step * Float(static_cast<double>(TileCache::kTileSize));
+    auto task = std::make_unique<ThreadTask>();
+    task->iterations = key.max_iterations;
+    task->precision = key.precision;
+    task->multiprecision_digits = key.multiprecision_digits;
+    task->algorithm = key.algorithm;
+    task->solid_guessing = key.solid_guessing;
+    task->palette = palette_;
+    task->world_start_point[0] = RealTraits<Float>::FromInteger(key.x) * tile_world_size;
+    task->world_start_point[1] = RealTraits<Float>::FromInteger(key.y) * tile_world_size;
+    task->world_step_per_pixel = Vector2f(tile_step);
+    task->region_screen_location = {0, 0};
+    task->region_screen_size = {TileCache::kTileSize, TileCache::kTileSize};
+    task->tile = key;
+    return task;
+}
+
+void FractalRenderingBackendCPU::QueueSpeculativeTiles()
+{
+    speculation_queued_ = true;
+    speculation_cursor_ = settings_.cursor_pixel;
+    if (!settings_.speculative_tiles || !tiled_frame_)
     {
+        return;
+    }
+
+    // World rectangle to cover with tiles of the level
+    struct Area
+    {
+        int level = 0;
+        Vector2f min;
+        Vector2f max;
+    };
+
+    const int level = tiled_frame_->level;
+    const Vector2f& camera = settings_.GetCamera();
+    const Vector2f& range = settings_.GetCoordRange();
+    auto make_view = [&](int view_level, const Vector2f& center, const Float& half_range_scale)
+    {
+        Area area{.level = view_level, .min = {}, .max = {}};
+        for (size_t axis = 0; axis != 2; ++axis)
+        {
+            const Float half_range = range[axis] * half_range_scale;
+            area.min[axis] = center[axis] - half_range;
+            area.max[axis] = center[axis] + half_range;
+        }
+        return area;
+    };
+
+    // Strips one tile wide along the sides of the screen the camera moves to
+    std::vector<Area> pan_strips;
+    const Area screen = make_view(level, camera, Float(0.5));
+    const Float tile_world_size = GetTileStep(level) * Float(static_cast<double>(TileCache::kTileSize));
+    for (size_t axis = 0; axis != 2; ++axis)
+    {
+        for (const int direction : {-1, 1})
+        {
+            if (pan_direction_[axis] != 0 && pan_direction_[axis] != direction)
+            {
+                continue;
+            }
+
+            Area strip = screen;
+            if (direction > 0)
+            {
+                strip.min[axis] = screen.max[axis];
+                strip.max[axis] = screen.max[axis] + tile_world_size;
+            }
+            else
+            {
+                strip.max[axis] = screen.min[axis];
+                strip.min[axis] = screen.min[axis] - tile_world_size;
+            }
+            pan_strips.push_back(strip);
+        }
+    }
+
+    // The most likely views first: the one in the direction of the last zoom, then pans
+    // A click moves the camera to the cursor before zooming in, so the zoom in view is centered on the cursor
+    // while it is over the viewport
+    Vector2f zoom_in_center = camera;
+    if (speculation_cursor_)
+    {
+        const size_t height = settings_.GetViewportHeight();
+        const size_t cursor_y = speculation_cursor_->y();
+        zoom_in_center = settings_.GetCoordAtPixel(speculation_cursor_->x(), height - std::min(cursor_y, height));
+    }
+
+    const Area zoom_in = make_view(level + 1, zoom_in_center, Float(0.25));
+    const Area zoom_out = make_view(level - 1, camera, Float(1));
+    std::vector<Area> areas;
+    if (zoom_direction_ > 0)
+    {
+        areas.push_back(zoom_in);
+    }
+    else if (zoom_direction_ < 0)
+    {
+        areas.push_back(zoom_out);
+    }
+
+    areas.insert(areas.end(), pan_strips.begin(), pan_strips.end());
+    if (zoom_direction_ <= 0)
+    {
+        areas.push_back(zoom_in);
+    }
+
+    if (zoom_direction_ >= 0)
+    {
+        areas.push_back(zoom_out);
+    }
+
+    std::vector<std::unique_ptr<ThreadTask>> tasks;
+    for (const Area& area : areas)
+    {
+        if (area.level < 0 || area.level > kMaxTileLevel)
+        {
+            continue;
+        }
+
+        const Float area_tile_size = GetTileStep(area.level) * Float(static_cast<double>(TileCache::kTileSize));
+        std::array<int64_t, 2> first{};
+        std::array<int64_t, 2> last{};
+        bool valid = true;
+        for (size_t axis = 0; axis != 2; ++axis)
+        {
+            const std::optional<int64_t> first_index = FloorDivide(area.min[axis], area_tile_size);
+            const std::optional<int64_t> last_index = FloorDivide(area.max[axis], area_tile_size);
+            valid = valid && first_index && last_index;
+            if (valid)
+            {
+                first[axis] = *first_index;
+                last[axis] = *last_index;
+            }
+        }
+
+        if (!valid)
+        {
+            continue;
+        }
+
+        TileKey key = MakeTileKey(area.level);
+        for (key.y = first[1]; key.y <= last[1]; ++key.y)
+        {
+            for (key.x = first[0]; key.x <= last[0]; ++key.x)
+            {
+                if (!HasTile(key))
+                {
+                    auto task = MakeTileTask(key);
+                    task->speculative = true;
+                    tasks.push_back(std::move(task));
+                }
+            }
+        }
+    }
+
+    QueueTasks(std::move(tasks));
+}
+
+std::optional<std::pair<Eigen::Vector2<size_t>, Eigen::Vector2<size_t>>> FractalRenderingBackendCPU::ResampleTile(
+    const TileKey& key,
+    std::span<const uint32_t> iterations)
+{
+    if (!tiled_frame_ || tiled_frame_->level != key.level)
+    {
+        return std::nullopt;
+    }
+
+    // Columns and rows are sorted, so the ones sampling this tile are contiguous
+    constexpr auto kTileSize = static_cast<int64_t>(TileCache::kTileSize);
+    auto find_range = [](const std::vector<int64_t>& samples, int64_t tile_begin)
+    {
+        const auto begin = std::ranges::lower_bound(samples, tile_begin);
+        const auto end = std::ranges::lower_bound(samples, tile_begin + kTileSize);
+        return std::pair{static_cast<size_t>(begin - samples.begin()), static_cast<size_t>(end - samples.begin())};
+    };
+
+    const int64_t tile_x = (key.x - tiled_frame_->first_tile_x) * kTileSize;
+    const int64_t tile_y = (key.y - tiled_frame_->first_tile_y) * kTileSize;
+    const auto [x_begin, x_end] = find_range(tiled_frame_->columns, tile_x);
+    const auto [y_begin, y_end] = find_range(tiled_frame_->rows, tile_y);
+    if (x_begin == x_end || y_begin == y_end)
+    {
+        return std::nullopt;
+    }
+
+    const size_t frame_width = texture->GetWidth();
+    for (size_t y = y_begin; y != y_end; ++y)
+    {
+        const auto tile_row_index = static_cast<size_t>(tiled_frame_->rows[y] - tile_y);
+        const auto tile_row = iterations.subspan(tile_row_index * TileCache::kTileSize, TileCache::kTileSize);
+        for (size_t x = x_begin; x != x_end; ++x)
+        {
+            frame_iterations_[y * frame_width + x] = tile_row[static_cast<size_t>(tiled_frame_->columns[x] - tile_x)];
+        }
+    }
+
+    return std::pair{
+        Eigen::Vector2<size_t>{x_begin, y_begin},
+        Eigen::Vector2<size_t>{x_end - x_begin, y_end - y_begin}};
+}
+
+void FractalRenderingBackendCPU::UpdateTileStore()
+{
+    if (!settings_.use_tile_cache || !settings_.persist_tiles)
+    {
+        tile_store_ = nullptr;
+        return;
+    }
+
+    if (tile_store_)
+    {
+        return;
+    }
+
+    try
+    {
+        tile_store_ = std::make_unique<TileStore>(app_.GetExecutableDir() / "tile_store");
+    }
+    catch (const std::exception& exception)
+    {
+        fmt::print("Failed to open the tile store: {}\n", exception.what());
+        settings_.persist_tiles = false;
+    }
+}
+
+void FractalRenderingBackendCPU::QueueTasks(std::vector<std::unique_ptr<ThreadTask>> tasks)
+{
+    for (auto& task : tasks)
+    {
+        task->epoch = frame_epoch_;
+        task->backend_epoch = &frame_epoch_;
         ThreadTask* task_ptr = task.get();
         tasks_.push_back(std::move(task));
-        [[maybe_unused]] const bool added = task_queue_.push(task_ptr);
-        assert(added);
+        workers_.Push(task_ptr);
     }
 }
 
@@ -311,25 +938,25 @@ void FractalRenderingBackendCPU::PostDraw()
         {
             prev_frame_duration_ = current_frame_duration_;
             current_frame_duration_ = std::nullopt;
+            prev_frame_stats_ = current_frame_stats_;
         }
     }
 
     // Settings has changed
     if (!settings_.settings_applied)
     {
-        // But previous were not rendered yet
-        if (in_progress)
-        {
-            // So cancell all current tasks and try again on the next frame
-            CancelAllTasks();
-        }
-        else
-        {
-            // Or start new frames
-            StartNewFractalFrame();
-            settings_.settings_applied = true;
-            current_frame_duration_ = 0.0f;
-        }
+        // Tasks of the previous frame and speculative tiles that are still running notice the new
+        // epoch and stop soon. The new frame starts right away instead of waiting for them.
+        CancelAllTasks();
+        StartNewFractalFrame();
+        settings_.settings_applied = true;
+        current_frame_duration_ = 0.0f;
+        current_frame_stats_ = {};
+    }
+    else if (!in_progress && (!speculation_queued_ || speculation_cursor_ != settings_.cursor_pixel))
+    {
+        // Cursor moves queue the zoom in view around the new position, tiles that exist are skipped
+        QueueSpeculativeTiles();
     }
 }
 
@@ -339,6 +966,6 @@ void FractalRenderingBackendCPU::CreateTexture()
     size_t window_height = app_.GetWindow().GetHeight();
     if (!texture || texture->GetWidth() != window_width || texture->GetHeight() != window_height)
     {
-        texture = klgl::Texture::CreateEmpty(window_width, window_height);
+        texture = klgl::Texture::CreateStreaming({window_width, window_height}, klgl::TextureFormat::RGBA8);
     }
 }
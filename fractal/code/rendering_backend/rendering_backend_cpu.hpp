@@ -1,18 +1,26 @@
 #pragma once
 
-#include <atomic>
-#include <chrono>
+#include <array>
 #include <concepts>
+#include <cstdint>
+#include <limits>
+#include <memory>
 #include <optional>
 #include <span>
-#include <thread>
+#include <utility>
 #include <vector>
 
-#include "boost/lockfree/queue.hpp"
+#include "cpu_worker_pool.hpp"
 #include "fractal_settings.hpp"
 #include "klgl/shader/uniform_handle.hpp"
 #include "klgl/wrap/wrap_eigen.hpp"
+#include "mandelbrot.hpp"
+#include "palette.hpp"
 #include "rendering_backend.hpp"
+#include "tile_cache.hpp"
+#include "tile_store.hpp"
+
+class PerturbationFrame;
 
 namespace klgl
 {
@@ -22,39 +30,6 @@ class Shader;
 struct MeshOpenGL;
 }  // namespace klgl
 
-struct ThreadTask
-{
-    Vector2f world_start_point;
-    Vector2f world_step_per_pixel;
-    Eigen::Vector2<size_t> region_screen_location;
-    Eigen::Vector2<size_t> region_screen_size;
-    std::vector<Eigen::Vector3<uint8_t>> colors;
-    size_t iterations;
-    size_t use_double = 64;
-    std::vector<uint16_t> pixels_iterations;
-    std::atomic_bool completed = false;
-    std::atomic_bool cancelled = false;
-    std::atomic<uint16_t> rows_completed = 0;
-    float task_duration_seconds = 0.0f;
-};
-
-class FractalCPURenderingThread
-{
-public:
-    FractalCPURenderingThread(boost::lockfree::queue<ThreadTask*>& task_queue);
-    ~FractalCPURenderingThread();
-    static Eigen::Vector3<uint8_t> ColorForIteration(ThreadTask& task, size_t iteration);
-
-private:
-    static void do_task(ThreadTask& task);
-    void thread_main();
-
-private:
-    std::thread thread_;
-    std::atomic_bool must_stop_ = false;
-    boost::lockfree::queue<ThreadTask*>& task_queue_;
-};
-
 class FractalRenderingBackendCPU : public FractalRenderingBackend
 {
 public:
@@ -62,8 +37,9 @@ public:
 
     constexpr static size_t kChunkWidth = 10;
     constexpr static size_t kChunkHeight = 10;
+    constexpr static int kMaxTileLevel = 48;
 
-    FractalRenderingBackendCPU(klgl::Application& app, FractalSettings& settings);
+    FractalRenderingBackendCPU(klgl::Application& app, FractalSettings& settings, FractalCPUWorkerPool& workers);
     ~FractalRenderingBackendCPU() override;
 
     void Draw() override;
@@ -78,6 +54,11 @@ public:
         return r;
     }
 
+    const MandelbrotStats& GetPreviousFrameStats() const
+    {
+        return prev_frame_stats_;
+    }
+
     template <typename Callback>
     requires std::invocable<Callback, const ThreadTask&>
     void ForEachTask(Callback&& callback) const
@@ -93,24 +74,117 @@ private:
     void HandleCompletedTasks();
     bool HasTasksInProgress() const;
     void StartNewFractalFrame();
+    // Composes the frame from cached tiles and queues the missing ones.
+    // Returns false if the zoom level can not be tiled.
+    bool StartTiledFrame();
+    // Copies iterations of the tile to the pixels of the tiled frame it covers and returns the covered rectangle
+    std::optional<std::pair<Eigen::Vector2<size_t>, Eigen::Vector2<size_t>>> ResampleTile(
+        const TileKey& key,
+        std::span<const uint32_t> iterations);
+    // Level and settings of tiles for the current settings, the caller fills the tile indices
+    TileKey MakeTileKey(int level) const;
+    std::unique_ptr<ThreadTask> MakeTileTask(const TileKey& key) const;
+    // Looks up the tile cache and then the tile store. The span is valid until the next call.
+    std::optional<std::span<const uint32_t>> FindTile(const TileKey& key);
+    // Checks the tile cache and the tile store without touching their stats or the LRU order
+    bool HasTile(const TileKey& key);
+    // While workers are idle, queues tiles of the views that are likely to be requested next:
+    // zoom in and out by one level and the strips beyond the screen edges.
+    void QueueSpeculativeTiles();
+    // Keeps a completely computed tile in the tile cache and the tile store
+    void StoreTile(ThreadTask& task);
+    // Opens or closes the persistent tile store to match settings
+    void UpdateTileStore();
+    void QueueTasks(std::vector<std::unique_ptr<ThreadTask>> tasks);
+    void UpdatePalette(uint32_t max_iterations);
+    // Stores iterations of completed tasks and optionally uploads their colors
+    void DisplayReadyTasks(bool upload);
+    // Uploads coarse previews of interleaved tasks that completed new passes
+    void DisplayTasksInProgress();
+    void StoreIterations(const ThreadTask& task);
+    void ShiftIterations(
+        const Eigen::Vector2<size_t>& old_size,
+        const Eigen::Vector2<size_t>& size,
+        const std::optional<std::array<ptrdiff_t, 2>>& shift);
+    std::optional<std::pair<Eigen::Vector2<size_t>, Eigen::Vector2<size_t>>> FindMissingPixels(
+        const Eigen::Vector2<size_t>& location,
+        const Eigen::Vector2<size_t>& size) const;
+    // Colorizes retained iterations of the region and uploads them
+    void UploadRegion(const Eigen::Vector2<size_t>& location, const Eigen::Vector2<size_t>& size);
+
+private:
+    // Settings that affect iterations of a pixel. Frames with the same key differ only by position and size.
+    struct FrameKey
+    {
+        Vector2f step;
+        uint32_t max_iterations = 0;
+        FractalPrecision precision = FractalPrecision::Double;
+        unsigned multiprecision_digits = 0;
+        FractalRenderAlgorithm algorithm = FractalRenderAlgorithm::BruteForce;
+        SolidGuessingOptions solid_guessing;
+        bool perturbation = false;
+        bool series_approximation = false;
+
+        bool operator==(const FrameKey&) const = default;
+    };
+
+    // Frame composed from tiles of one level
+    struct TiledFrame
+    {
+        int level = 0;
+        // Tile that contains the first pixel of the frame
+        int64_t first_tile_x = 0;
+        int64_t first_tile_y = 0;
+        // Tile pixel sampled by every column and row of the frame, counted from the first tile
+        std::vector<int64_t> columns;
+        std::vector<int64_t> rows;
+    };
 
 private:
     klgl::Application& app_;
     FractalSettings& settings_;
+    FractalCPUWorkerPool& workers_;
 
     std::optional<float> prev_frame_duration_;
     std::optional<float> current_frame_duration_;
+    MandelbrotStats prev_frame_stats_;
+    MandelbrotStats current_frame_stats_;
 
+    PrecisionChoice precision_choice_;
+    std::shared_ptr<PerturbationFrame> perturbation_frame_;
     std::vector<std::unique_ptr<ThreadTask>> tasks_;
     std::vector<std::unique_ptr<ThreadTask>> ready_for_display_;
-    boost::lockfree::queue<ThreadTask*> task_queue_;
+    // Incremented when a frame is cancelled. Tasks of older epochs stop at the next pixel batch
+    // and are dropped when they complete, while tasks of the next frame already run.
+    std::atomic<uint64_t> frame_epoch_ = 0;
 
     std::unique_ptr<klgl::Shader> render_texture_shader;
     klgl::UniformHandle texture_loc;
     std::unique_ptr<klgl::MeshOpenGL> quad_mesh;
 
-    std::vector<std::unique_ptr<FractalCPURenderingThread>> workers_;
     std::unique_ptr<klgl::Texture> texture;
 
+    // Iterations of the whole texture so that palette changes do not recompute anything.
+    // Pixels that were not computed yet hold kNotComputed.
+    constexpr static uint32_t kNotComputed = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> frame_iterations_;
+    std::optional<FrameKey> frame_key_;
+    Vector2f frame_origin_;
+    std::shared_ptr<const PaletteLut> palette_;
+    TileCache tile_cache_;
+    std::unique_ptr<TileStore> tile_store_;
+    std::optional<TiledFrame> tiled_frame_;
+    // Camera and step of the previous frame and the direction of the last zoom (1 is in) and pan
+    std::optional<Vector2f> last_step_;
+    Vector2f last_camera_;
+    int zoom_direction_ = 0;
+    std::array<int, 2> pan_direction_{};
+    bool speculation_queued_ = false;
+    // Cursor pixel the zoom in view of the queued speculative tiles is centered on
+    std::optional<Eigen::Vector2<size_t>> speculation_cursor_;
+    size_t speculative_tiles_computed_ = 0;
+    std::vector<uint32_t> upload_pixels_;
+    std::vector<uint32_t> preview_iterations_;
+
     std::vector<float> cpu_frames_durations_;
 };
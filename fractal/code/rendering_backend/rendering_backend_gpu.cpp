@@ -17,6 +17,7 @@ FractalRenderingBackendGPU::FractalRenderingBackendGPU(klgl::Application& app, F
     pos_loc = shader_->GetUniform("uCameraPos");
     scale_loc = shader_->GetUniform("uScale");
     viewport_size_loc = shader_->GetUniform("uViewportSize");
+    max_iterations_loc = shader_->GetUniform("uMaxIterations");
 
     size_t uniforms_count = colors_uniforms.size();
     for (size_t i = 0; i != uniforms_count; ++i)
@@ -42,12 +43,13 @@ void FractalRenderingBackendGPU::Draw()
 {
     klgl::ScopeAnnotation annotation("Render fractal on gpu");
     const Eigen::Vector2f camera_f{
-        static_cast<float>(settings_.GetCamera().x()),
-        static_cast<float>(settings_.GetCamera().y())};
+        static_cast<float>(static_cast<double>(settings_.GetCamera().x())),
+        static_cast<float>(static_cast<double>(settings_.GetCamera().y()))};
     const auto scale = settings_.GetScale();
     shader_->SetUniform(pos_loc, camera_f);
-    shader_->SetUniform(scale_loc, static_cast<float>(scale));
+    shader_->SetUniform(scale_loc, static_cast<float>(static_cast<double>(scale)));
     shader_->SetUniform(viewport_size_loc, app_.GetWindow().GetSize2f());
+    shader_->SetUniform(max_iterations_loc, static_cast<float>(settings_.max_iterations));
     for (size_t color_index = 0; color_index != colors_uniforms.size(); ++color_index)
     {
         shader_->SetUniform(colors_uniforms[color_index], settings_.colors[color_index]);
@@ -29,6 +29,7 @@ private:
     klgl::UniformHandle pos_loc;
     klgl::UniformHandle scale_loc;
     klgl::UniformHandle viewport_size_loc;
+    klgl::UniformHandle max_iterations_loc;
 
     std::unique_ptr<klgl::MeshOpenGL> quad_mesh;
     std::array<klgl::UniformHandle, FractalSettings::colors_count> colors_uniforms;
@@ -0,0 +1,223 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "iteration_grid.hpp"
+#include "mandelbrot.hpp"
+
+struct SolidGuessingOptions
+{
+    static constexpr int kMaxAggressiveness = 4;
+
+    // 0: every 4th pixel first, neighbour samples must agree
+    // 1: every 4th pixel first
+    // 2: every 8th pixel first, neighbour samples must agree
+    // 3: every 8th pixel first
+    // 4: every 16th pixel first
+    static SolidGuessingOptions FromAggressiveness(int aggressiveness, bool verify)
+    {
+        SolidGuessingOptions options;
+        options.coarse_step = size_t{4} << (aggressiveness / 2);
+        options.check_neighbours = aggressiveness % 2 == 0 && aggressiveness != kMaxAggressiveness;
+        options.verify = verify;
+        return options;
+    }
+
+    // Step of the first pass, a power of two
+    size_t coarse_step = 8;
+    // Also require the ring of samples around the enclosing block to agree
+    bool check_neighbours = true;
+    // Iterate guessed pixels as well and count wrong guesses (the guesses are kept in the image)
+    bool verify = false;
+
+    // The first pass and one pass per halving of the step
+    size_t GetPassesCount() const
+    {
+        return static_cast<size_t>(std::countr_zero(coarse_step)) + 1;
+    }
+
+    // After passes_completed passes every pixel with both coordinates divisible by the step is known
+    PixelIndex GetPreviewStep(size_t passes_completed) const
+    {
+        const size_t step = passes_completed == 0 ? coarse_step : coarse_step >> (passes_completed - 1);
+        return {step, step};
+    }
+
+    bool operator==(const SolidGuessingOptions&) const = default;
+};
+
+// Fractint-style solid guessing. The first pass iterates every coarse_step-th pixel of every
+// coarse_step-th row. Each next pass halves the step: a new pixel is guessed when the samples of
+// the previous pass around it agree and iterated otherwise. Blocks inside the set or inside one
+// escape band are filled without iterating, while the passes refine towards band boundaries.
+// passes_completed is released after each pass but the last: pixels of completed passes may be read
+// by another thread to preview the region while the next pass is computed.
+// Evaluator::ComputePixels(std::span<const PixelIndex>) iterates the given pixels into the grid.
+template <typename Evaluator>
+class SolidGuessingFill
+{
+public:
+    SolidGuessingFill(
+        IterationGrid grid,
+        Evaluator& evaluator,
+        const SolidGuessingOptions& options,
+        std::atomic<uint8_t>& passes_completed,
+        MandelbrotStats& stats)
+        : grid_(grid),
+          evaluator_(evaluator),
+          options_(options),
+          passes_completed_(passes_completed),
+          stats_(stats)
+    {
+    }
+
+    void Run()
+    {
+        if (grid_.width == 0 || grid_.height == 0)
+        {
+            return;
+        }
+
+        const size_t coarse_step = options_.coarse_step;
+        batch_.clear();
+        for (size_t y = 0; y < grid_.height; y += coarse_step)
+        {
+            for (size_t x = 0; x < grid_.width; x += coarse_step)
+            {
+                batch_.push_back({x, y});
+            }
+        }
+
+        ComputeBatch();
+
+        guessed_.clear();
+        for (size_t step = coarse_step; step != 1; step /= 2)
+        {
+            // Passes with steps down to this one are complete. The last pass is not published
+            // because verification rewrites guessed pixels.
+            const int passes = std::countr_zero(coarse_step) - std::countr_zero(step) + 1;
+            passes_completed_.store(static_cast<uint8_t>(passes), std::memory_order_release);
+            const size_t half = step / 2;
+            batch_.clear();
+            for (size_t y = 0; y < grid_.height; y += half)
+            {
+                for (size_t x = 0; x < grid_.width; x += half)
+                {
+                    if (x % step == 0 && y % step == 0)
+                    {
+                        continue;
+                    }
+
+                    uint32_t value = 0;
+                    if (TryGuess(x, y, step, value))
+                    {
+                        grid_.At(x, y) = value;
+                        ++stats_.pixels_filled;
+                        if (options_.verify)
+                        {
+                            guessed_.push_back({x, y});
+                        }
+                    }
+                    else
+                    {
+                        batch_.push_back({x, y});
+                    }
+                }
+            }
+
+            ComputeBatch();
+        }
+
+        if (options_.verify)
+        {
+            Verify();
+        }
+    }
+
+private:
+    void ComputeBatch()
+    {
+        if (!batch_.empty())
+        {
+            evaluator_.ComputePixels(batch_);
+        }
+    }
+
+    // Samples of the previous pass are the pixels with both coordinates divisible by step
+    bool TryGuess(size_t x, size_t y, size_t step, uint32_t& value) const
+    {
+        const size_t x_low = x / step * step;
+        const size_t y_low = y / step * step;
+        const size_t x_high = x == x_low ? x_low : x_low + step;
+        const size_t y_high = y == y_low ? y_low : y_low + step;
+        if (x_high >= grid_.width || y_high >= grid_.height)
+        {
+            return false;
+        }
+
+        const size_t margin = options_.check_neighbours ? step : 0;
+        const size_t x_begin = x_low >= margin ? x_low - margin : x_low;
+        const size_t y_begin = y_low >= margin ? y_low - margin : y_low;
+        const size_t x_end = x_high + margin < grid_.width ? x_high + margin : x_high;
+        const size_t y_end = y_high + margin < grid_.height ? y_high + margin : y_high;
+
+        value = grid_.At(x_low, y_low);
+        for (size_t sample_y = y_begin; sample_y <= y_end; sample_y += step)
+        {
+            for (size_t sample_x = x_begin; sample_x <= x_end; sample_x += step)
+            {
+                if (grid_.At(sample_x, sample_y) != value)
+                {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    // Verification work is not included into the stats
+    void Verify()
+    {
+        const MandelbrotStats stats_before = stats_;
+
+        guesses_.clear();
+        for (const PixelIndex& pixel : guessed_)
+        {
+            guesses_.push_back(grid_.At(pixel.x, pixel.y));
+        }
+
+        if (!guessed_.empty())
+        {
+            evaluator_.ComputePixels(guessed_);
+        }
+
+        size_t wrong_guesses = 0;
+        for (size_t index = 0; index != guessed_.size(); ++index)
+        {
+            uint32_t& value = grid_.At(guessed_[index].x, guessed_[index].y);
+            if (value != guesses_[index])
+            {
+                ++wrong_guesses;
+                value = guesses_[index];
+            }
+        }
+
+        stats_ = stats_before;
+        stats_.wrong_guesses += wrong_guesses;
+    }
+
+private:
+    IterationGrid grid_;
+    Evaluator& evaluator_;
+    SolidGuessingOptions options_;
+    std::atomic<uint8_t>& passes_completed_;
+    MandelbrotStats& stats_;
+    std::vector<PixelIndex> batch_;
+    std::vector<PixelIndex> guessed_;
+    std::vector<uint32_t> guesses_;
+};
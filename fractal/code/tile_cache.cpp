@@ -0,0 +1,72 @@
+#include "tile_cache.hpp"
+
+#include <cassert>
+
+static void HashCombine(size_t& seed, size_t value)
+{
+    seed ^= value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+}
+
+size_t TileKeyHash::operator()(const TileKey& key) const
+{
+    size_t seed = std::hash<int>{}(key.level);
+    HashCombine(seed, std::hash<int64_t>{}(key.x));
+    HashCombine(seed, std::hash<int64_t>{}(key.y));
+    HashCombine(seed, key.max_iterations);
+    HashCombine(seed, static_cast<size_t>(key.precision));
+    HashCombine(seed, key.multiprecision_digits);
+    HashCombine(seed, static_cast<size_t>(key.algorithm));
+    HashCombine(seed, key.solid_guessing.coarse_step);
+    return seed;
+}
+
+TileCache::TileCache(size_t byte_budget) : byte_budget_(byte_budget) {}
+
+const std::vector<uint32_t>* TileCache::Find(const TileKey& key)
+{
+    const auto it = index_.find(key);
+    if (it == index_.end())
+    {
+        ++stats_.misses;
+        return nullptr;
+    }
+
+    ++stats_.hits;
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return &it->second->iterations;
+}
+
+void TileCache::Insert(const TileKey& key, std::vector<uint32_t> iterations)
+{
+    assert(iterations.size() == kTileSize * kTileSize);
+
+    if (const auto it = index_.find(key); it != index_.end())
+    {
+        bytes_ -= it->second->iterations.size() * sizeof(uint32_t);
+        lru_.erase(it->second);
+        index_.erase(it);
+    }
+
+    bytes_ += iterations.size() * sizeof(uint32_t);
+    lru_.push_front(Entry{key, std::move(iterations)});
+    index_[key] = lru_.begin();
+    Evict();
+}
+
+void TileCache::SetByteBudget(size_t byte_budget)
+{
+    byte_budget_ = byte_budget;
+    Evict();
+}
+
+void TileCache::Evict()
+{
+    while (bytes_ > byte_budget_ && !lru_.empty())
+    {
+        const Entry& entry = lru_.back();
+        bytes_ -= entry.iterations.size() * sizeof(uint32_t);
+        index_.erase(entry.key);
+        lru_.pop_back();
+        ++stats_.evictions;
+    }
+}
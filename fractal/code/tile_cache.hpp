@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include "precision.hpp"
+#include "render_algorithm.hpp"
+#include "solid_guessing.hpp"
+
+// Tile of the world-aligned quadtree: at level L a tile covers a square of 2^(2 - L) world units
+// starting at (x, y) * 2^(2 - L), so the tile pixel size is 2^(2 - L) / kTileSize.
+// The rest of the key are settings that change iterations of a pixel.
+struct TileKey
+{
+    int level = 0;
+    int64_t x = 0;
+    int64_t y = 0;
+    uint32_t max_iterations = 0;
+    FractalPrecision precision = FractalPrecision::Double;
+    unsigned multiprecision_digits = 0;
+    FractalRenderAlgorithm algorithm = FractalRenderAlgorithm::BruteForce;
+    SolidGuessingOptions solid_guessing;
+
+    bool operator==(const TileKey&) const = default;
+};
+
+struct TileKeyHash
+{
+    size_t operator()(const TileKey& key) const;
+};
+
+// Iterations of computed tiles with least recently used eviction once the byte budget is exceeded
+class TileCache
+{
+public:
+    static constexpr size_t kTileSize = 128;
+
+    struct Stats
+    {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t evictions = 0;
+    };
+
+    explicit TileCache(size_t byte_budget);
+
+    // Returns kTileSize * kTileSize iterations (row by row) or nullptr. The pointer is valid until the next Insert.
+    const std::vector<uint32_t>* Find(const TileKey& key);
+
+    // Unlike Find it does not count a hit or a miss and does not mark the tile as used
+    bool Contains(const TileKey& key) const
+    {
+        return index_.contains(key);
+    }
+
+    void Insert(const TileKey& key, std::vector<uint32_t> iterations);
+
+    void SetByteBudget(size_t byte_budget);
+
+    size_t GetByteBudget() const
+    {
+        return byte_budget_;
+    }
+
+    size_t GetBytes() const
+    {
+        return bytes_;
+    }
+
+    size_t GetTilesCount() const
+    {
+        return index_.size();
+    }
+
+    const Stats& GetStats() const
+    {
+        return stats_;
+    }
+
+private:
+    struct Entry
+    {
+        TileKey key;
+        std::vector<uint32_t> iterations;
+    };
+
+    void Evict();
+
+private:
+    // Most recently used tiles are at the front
+    std::list<Entry> lru_;
+    std::unordered_map<TileKey, std::list<Entry>::iterator, TileKeyHash> index_;
+    size_t byte_budget_ = 0;
+    size_t bytes_ = 0;
+    Stats stats_;
+};
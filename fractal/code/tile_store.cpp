@@ -0,0 +1,298 @@
+#include "tile_store.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include "boost/interprocess/sync/scoped_lock.hpp"
+#include "fmt/format.h"
+
+namespace bip = boost::interprocess;
+
+struct TileStoreIndexHeader
+{
+    uint64_t magic;
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t slots_count;
+    // Whole records at the start of the log, the rest of the file is preallocated
+    uint64_t records_count;
+    std::array<uint64_t, 4> reserved;
+};
+
+// Record key, compared byte by byte
+struct TileStoreRecordHeader
+{
+    uint64_t magic;
+    int64_t x;
+    int64_t y;
+    int32_t level;
+    uint32_t max_iterations;
+    uint32_t precision;
+    uint32_t multiprecision_digits;
+    uint32_t algorithm;
+    uint32_t coarse_step;
+    uint32_t check_neighbours;
+    uint32_t verify;
+    uint64_t reserved;
+};
+
+static_assert(sizeof(TileStoreIndexHeader) == 64);
+static_assert(sizeof(TileStoreRecordHeader) == 64);
+
+static constexpr uint64_t kIndexMagic = 0x58444e49454c4954;  // "TILEINDX"
+static constexpr uint64_t kRecordMagic = 0x44524345524c4954;  // "TILRECRD"
+static constexpr uint32_t kFormatVersion = 2;
+static constexpr size_t kSlotsCount = size_t{1} << 20;
+static constexpr size_t kMaxProbes = 64;
+static constexpr size_t kTilePixels = TileCache::kTileSize * TileCache::kTileSize;
+static constexpr size_t kRecordSize = sizeof(TileStoreRecordHeader) + kTilePixels * sizeof(uint32_t);
+static constexpr size_t kIndexSize = sizeof(TileStoreIndexHeader) + kSlotsCount * sizeof(uint64_t);
+// The log doubles, but by at least 1 MB and at most 64 MB at a time
+static constexpr uint64_t kMinLogGrowthRecords = 16;
+static constexpr uint64_t kMaxLogGrowthRecords = 1024;
+
+static TileStoreRecordHeader MakeRecordHeader(const TileKey& key)
+{
+    TileStoreRecordHeader header{};
+    header.magic = kRecordMagic;
+    header.x = key.x;
+    header.y = key.y;
+    header.level = key.level;
+    header.max_iterations = key.max_iterations;
+    header.precision = static_cast<uint32_t>(key.precision);
+    header.multiprecision_digits = key.multiprecision_digits;
+    header.algorithm = static_cast<uint32_t>(key.algorithm);
+    header.coarse_step = static_cast<uint32_t>(key.solid_guessing.coarse_step);
+    header.check_neighbours = key.solid_guessing.check_neighbours ? 1 : 0;
+    header.verify = key.solid_guessing.verify ? 1 : 0;
+    return header;
+}
+
+// Unlike std::hash it is the same for every build, so instances agree on the slots
+static uint64_t HashRecordHeader(const TileStoreRecordHeader& header)
+{
+    std::array<uint64_t, sizeof(header) / sizeof(uint64_t)> words{};
+    std::memcpy(words.data(), &header, sizeof(header));
+
+    uint64_t hash = 0;
+    for (const uint64_t word : words)
+    {
+        // splitmix64 finalizer
+        hash ^= word;
+        hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ull;
+        hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebull;
+        hash ^= hash >> 31;
+    }
+
+    return hash;
+}
+
+static size_t GetSlotIndex(uint64_t hash, size_t probe)
+{
+    return static_cast<size_t>((hash + probe) % kSlotsCount);
+}
+
+TileStore::TileStore(const std::filesystem::path& directory)
+    : directory_(directory),
+      index_path_(directory / "tiles.index"),
+      log_path_(directory / "tiles.log")
+{
+    std::filesystem::create_directories(directory_);
+
+    // File mappings and file locks need existing files
+    const std::filesystem::path lock_path = directory_ / "tiles.lock";
+    for (const std::filesystem::path& path : {lock_path, index_path_, log_path_})
+    {
+        std::ofstream file(path, std::ios::app | std::ios::binary);
+        if (!file)
+        {
+            throw std::runtime_error(fmt::format("Failed to create {}", path.string()));
+        }
+    }
+
+    writers_lock_ = bip::file_lock(lock_path.string().c_str());
+    {
+        bip::scoped_lock<bip::file_lock> lock(writers_lock_);
+        OpenIndex();
+    }
+
+    MapLog();
+}
+
+void TileStore::OpenIndex()
+{
+    if (std::filesystem::file_size(index_path_) == 0)
+    {
+        // Slots of a new file are zero, that is empty
+        std::filesystem::resize_file(index_path_, kIndexSize);
+    }
+
+    index_file_ = bip::file_mapping(index_path_.string().c_str(), bip::read_write);
+    index_region_ = bip::mapped_region(index_file_, bip::read_write);
+    if (index_region_.get_size() != kIndexSize)
+    {
+        throw std::runtime_error(fmt::format("{} has unexpected size", index_path_.string()));
+    }
+
+    TileStoreIndexHeader header{};
+    std::memcpy(&header, index_region_.get_address(), sizeof(header));
+    if (header.magic == 0)
+    {
+        header.magic = kIndexMagic;
+        header.version = kFormatVersion;
+        header.record_size = static_cast<uint32_t>(kRecordSize);
+        header.slots_count = kSlotsCount;
+        std::memcpy(index_region_.get_address(), &header, sizeof(header));
+    }
+
+    if (header.magic != kIndexMagic || header.version != kFormatVersion || header.record_size != kRecordSize ||
+        header.slots_count != kSlotsCount)
+    {
+        throw std::runtime_error(fmt::format("{} was written by an incompatible version", index_path_.string()));
+    }
+
+    auto* header_address = static_cast<std::byte*>(index_region_.get_address());
+    records_count_ = reinterpret_cast<uint64_t*>(header_address + offsetof(TileStoreIndexHeader, records_count));
+    slots_ = reinterpret_cast<uint64_t*>(header_address + sizeof(header));
+}
+
+void TileStore::MapLog()
+{
+    log_region_ = bip::mapped_region();
+    if (std::filesystem::file_size(log_path_) < kRecordSize)
+    {
+        return;
+    }
+
+    log_file_ = bip::file_mapping(log_path_.string().c_str(), bip::read_write);
+    log_region_ = bip::mapped_region(log_file_, bip::read_write);
+}
+
+const std::byte* TileStore::GetRecord(uint64_t record_index)
+{
+    const uint64_t record_end = (record_index + 1) * kRecordSize;
+    if (record_end > log_region_.get_size())
+    {
+        MapLog();
+        if (record_end > log_region_.get_size())
+        {
+            return nullptr;
+        }
+    }
+
+    return static_cast<const std::byte*>(log_region_.get_address()) + record_index * kRecordSize;
+}
+
+uint64_t TileStore::LoadSlot(size_t slot_index) const
+{
+    // Pairs with the release store in Append of this or another instance
+    return std::atomic_ref<uint64_t>(slots_[slot_index]).load(std::memory_order_acquire);
+}
+
+const std::byte* TileStore::FindRecord(const TileKey& key)
+{
+    const TileStoreRecordHeader header = MakeRecordHeader(key);
+    const uint64_t hash = HashRecordHeader(header);
+    for (size_t probe = 0; probe != kMaxProbes; ++probe)
+    {
+        const uint64_t slot = LoadSlot(GetSlotIndex(hash, probe));
+        if (slot == 0)
+        {
+            break;
+        }
+
+        const std::byte* record = GetRecord(slot - 1);
+        if (record && std::memcmp(record, &header, sizeof(header)) == 0)
+        {
+            return record;
+        }
+    }
+
+    return nullptr;
+}
+
+std::optional<std::span<const uint32_t>> TileStore::Find(const TileKey& key)
+{
+    const std::byte* record = FindRecord(key);
+    if (!record)
+    {
+        ++stats_.misses;
+        return std::nullopt;
+    }
+
+    ++stats_.hits;
+    return std::span{reinterpret_cast<const uint32_t*>(record + sizeof(TileStoreRecordHeader)), kTilePixels};
+}
+
+bool TileStore::Contains(const TileKey& key)
+{
+    return FindRecord(key) != nullptr;
+}
+
+void TileStore::Append(const TileKey& key, std::span<const uint32_t> iterations)
+{
+    assert(iterations.size() == kTilePixels);
+    bip::scoped_lock<bip::file_lock> lock(writers_lock_);
+
+    const TileStoreRecordHeader header = MakeRecordHeader(key);
+    const uint64_t hash = HashRecordHeader(header);
+    std::optional<size_t> free_slot;
+    for (size_t probe = 0; probe != kMaxProbes; ++probe)
+    {
+        const size_t slot_index = GetSlotIndex(hash, probe);
+        const uint64_t slot = LoadSlot(slot_index);
+        if (slot == 0)
+        {
+            free_slot = slot_index;
+            break;
+        }
+
+        // Could be stored by another instance
+        const std::byte* record = GetRecord(slot - 1);
+        if (record && std::memcmp(record, &header, sizeof(header)) == 0)
+        {
+            return;
+        }
+    }
+
+    if (!free_slot)
+    {
+        return;
+    }
+
+    // The record goes after the last counted record. The file is resized and remapped only when the record
+    // is beyond the mapping, another instance could have grown the file already.
+    const uint64_t record_index = std::atomic_ref<uint64_t>(*records_count_).load(std::memory_order_relaxed);
+    const uint64_t record_end = (record_index + 1) * kRecordSize;
+    if (record_end > log_region_.get_size())
+    {
+        const uint64_t log_size = std::filesystem::file_size(log_path_);
+        if (record_end > log_size)
+        {
+            const uint64_t log_records = log_size / kRecordSize;
+            const uint64_t growth = std::clamp(log_records, kMinLogGrowthRecords, kMaxLogGrowthRecords);
+            std::filesystem::resize_file(log_path_, std::max(record_index + 1, log_records + growth) * kRecordSize);
+        }
+
+        MapLog();
+    }
+
+    std::byte* record = static_cast<std::byte*>(log_region_.get_address()) + record_index * kRecordSize;
+    std::memcpy(record, &header, sizeof(header));
+    std::memcpy(record + sizeof(header), iterations.data(), iterations.size_bytes());
+    // A writer that crashes before this leaves the record uncounted, the next one overwrites it
+    std::atomic_ref<uint64_t>(*records_count_).store(record_index + 1, std::memory_order_relaxed);
+    std::atomic_ref<uint64_t>(slots_[*free_slot]).store(record_index + 1, std::memory_order_release);
+    ++stats_.appends;
+}
+
+size_t TileStore::GetTilesCount() const
+{
+    return static_cast<size_t>(std::atomic_ref<uint64_t>(*records_count_).load(std::memory_order_relaxed));
+}
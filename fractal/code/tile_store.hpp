@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+
+#include "boost/interprocess/file_mapping.hpp"
+#include "boost/interprocess/mapped_region.hpp"
+#include "boost/interprocess/sync/file_lock.hpp"
+#include "tile_cache.hpp"
+
+// Tiles of the tile cache persisted in a directory shared by all app instances on the machine.
+// tiles.log is an append-only log of fixed size records (key and iterations of one tile) and
+// tiles.index is an open addressing hash table of record numbers. Both files are memory mapped.
+// The log grows geometrically ahead of the records and the index header keeps the records count.
+// Writers append a record and then publish its number in a free index slot, other writers are
+// excluded with a file lock. Readers take no locks: a published slot always points to a complete
+// record and records are never modified.
+// One instance must be used from one thread.
+class TileStore
+{
+public:
+    struct Stats
+    {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t appends = 0;
+    };
+
+    // Throws if the files can not be opened or were written by another format version
+    explicit TileStore(const std::filesystem::path& directory);
+
+    // kTileSize * kTileSize iterations (row by row). The span is valid until the next Find or Append.
+    std::optional<std::span<const uint32_t>> Find(const TileKey& key);
+
+    // Unlike Find it does not count a hit or a miss
+    bool Contains(const TileKey& key);
+
+    // Skips tiles that are already stored and tiles that do not fit into the index
+    void Append(const TileKey& key, std::span<const uint32_t> iterations);
+
+    // Records in the log including the ones appended by other instances
+    size_t GetTilesCount() const;
+
+    const std::filesystem::path& GetDirectory() const
+    {
+        return directory_;
+    }
+
+    const Stats& GetStats() const
+    {
+        return stats_;
+    }
+
+private:
+    void OpenIndex();
+    void MapLog();
+    // Remaps the log if the record was appended by another instance after the last mapping
+    const std::byte* GetRecord(uint64_t record_index);
+    uint64_t LoadSlot(size_t slot_index) const;
+    // Published record of the tile or nullptr
+    const std::byte* FindRecord(const TileKey& key);
+
+private:
+    std::filesystem::path directory_;
+    std::filesystem::path index_path_;
+    std::filesystem::path log_path_;
+    boost::interprocess::file_lock writers_lock_;
+    boost::interprocess::file_mapping index_file_;
+    boost::interprocess::mapped_region index_region_;
+    boost::interprocess::file_mapping log_file_;
+    boost::interprocess::mapped_region log_region_;
+    uint64_t* records_count_ = nullptr;
+    uint64_t* slots_ = nullptr;
+    Stats stats_;
+};
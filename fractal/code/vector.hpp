@@ -5,7 +5,7 @@
 #include <type_traits>
 
 #include "float.hpp"
-#include "klgl/wrap/wrap_eigen.hpp"
+#include "wrap_eigen.hpp"
 
 template <typename T, size_t N>
 class Vector
@@ -197,6 +197,8 @@ public:
         return data[2];
     }
 
+    bool operator==(const Vector<T, N>& another) const = default;
+
     void Fill(const T& arg)
     {
         for (auto& v : data)
@@ -0,0 +1,24 @@
+#pragma once
+
+// Eigen for the engine, which does not depend on klgl. Eigen headers do not pass the warnings of the project.
+// clang-format off
+#if defined(__GNUC__) || defined(__clang__)
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wsign-conversion"
+    #pragma GCC diagnostic ignored "-Wzero-as-null-pointer-constant"
+    #pragma GCC diagnostic ignored "-Wold-style-cast"
+    #pragma GCC diagnostic ignored "-Wfloat-equal"
+#elif defined(_MSC_VER)
+    #pragma warning(push)
+    #pragma warning(disable : 4201)
+    #pragma warning(disable : 5054)
+#endif
+// clang-format on
+
+#include "Eigen/Dense"
+
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic pop
+#elif defined(_MSC_VER)
+#pragma warning(pop)
+#endif
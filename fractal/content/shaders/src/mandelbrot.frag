@@ -1,9 +1,10 @@
-#define MAX_ITERATIONS 1000
 #define COLORS_COUNT 10
 
 uniform vec2 uCameraPos;
 uniform vec2 uViewportSize;
 uniform float uScale;
+// Float is exact for any integer up to the settings limit (2^24)
+uniform float uMaxIterations;
 uniform vec3 uColorTable[COLORS_COUNT];
 out vec4 fragColor;
 
@@ -12,26 +13,27 @@ vec3 GetColorByIndex(int index)
     return uColorTable[index];
 }
 
-vec3 ColorForIteration(int iteration)
+vec3 ColorForIteration(int iteration, int max_iterations)
 {
-    if (iteration == MAX_ITERATIONS)
+    if (iteration == max_iterations)
         return vec3(0, 0, 0);
 
+    // Same mapping as PaletteLut::Build: iteration lies at iteration * segments / max_iterations along
+    // the gradient, the integer part selects the segment and the remainder is the position within it
     const int segments_count = COLORS_COUNT - 1;
-    const int iterations_per_segment = MAX_ITERATIONS / segments_count;
     int k = iteration * segments_count;
-    int first_color_index = k / MAX_ITERATIONS;
+    int first_color_index = k / max_iterations;
     vec3 color_a = GetColorByIndex(first_color_index);
     vec3 color_b = GetColorByIndex(first_color_index + 1);
-    float p = float(k % iterations_per_segment) / iterations_per_segment;
+    float p = float(k % max_iterations) / float(max_iterations);
     return color_a + p * (color_b - color_a);
 }
 
-int DoMandelbrotLoop(vec2 p0)
+int DoMandelbrotLoop(vec2 p0, int max_iterations)
 {
     vec2 p = vec2(0, 0);
     int iteration = 0;
-    while (dot(p, p) <= 4.0 && iteration != MAX_ITERATIONS)
+    while (dot(p, p) <= 4.0 && iteration != max_iterations)
     {
         float x_temp = p.x * p.x - p.y * p.y + p0.x;
         p.y = 2 * p.x * p.y + p0.y;
@@ -62,7 +64,8 @@ void main()
     vec2 range = uScale * (max_coord - min_coord);
     vec2 frag_pos = gl_FragCoord.xy / uViewportSize;
     vec2 coord = uCameraPos + range * (frag_pos - 0.5);
-    int iterations = DoMandelbrotLoop(coord);
+    int max_iterations = int(uMaxIterations);
+    int iterations = DoMandelbrotLoop(coord, max_iterations);
     fragColor.a = 1;
-    fragColor.rgb = ColorForIteration(iterations);
+    fragColor.rgb = ColorForIteration(iterations, max_iterations);
 }
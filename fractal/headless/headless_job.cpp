@@ -0,0 +1,268 @@
+#include "headless_job.hpp"
+
+#include <array>
+#include <charconv>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include "fmt/format.h"
+#include "real_traits.hpp"
+
+static constexpr std::array<std::pair<std::string_view, FractalRenderAlgorithm>, kFractalRenderAlgorithmCount>
+    kAlgorithmNames{{
+        {"brute-force", FractalRenderAlgorithm::BruteForce},
+        {"mariani-silver", FractalRenderAlgorithm::MarianiSilver},
+        {"boundary-tracing", FractalRenderAlgorithm::BoundaryTracing},
+        {"solid-guessing", FractalRenderAlgorithm::SolidGuessing},
+        {"interleaved", FractalRenderAlgorithm::Interleaved},
+    }};
+
+static constexpr std::array<std::pair<std::string_view, FractalPrecision>, kFractalPrecisionCount> kPrecisionNames{{
+    {"float", FractalPrecision::Single},
+    {"double", FractalPrecision::Double},
+    {"double-double", FractalPrecision::DoubleDouble},
+    {"quad-double", FractalPrecision::QuadDouble},
+    {"multiprecision", FractalPrecision::Multiprecision},
+}};
+
+template <typename T>
+static T ParseInteger(std::string_view name, std::string_view value, T min_value, T max_value)
+{
+    T result{};
+    const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), result);
+    if (error != std::errc{} || end != value.data() + value.size() || result < min_value || result > max_value)
+    {
+        throw std::runtime_error(
+            fmt::format("{} expects an integer in [{}, {}], got \"{}\"", name, min_value, max_value, value));
+    }
+
+    return result;
+}
+
+template <typename T, size_t N>
+static T ParseName(
+    std::string_view name,
+    std::string_view value,
+    const std::array<std::pair<std::string_view, T>, N>& names)
+{
+    for (const auto& [known_name, known_value] : names)
+    {
+        if (known_name == value)
+        {
+            return known_value;
+        }
+    }
+
+    throw std::runtime_error(fmt::format("Unknown {} value \"{}\"", name, value));
+}
+
+static std::string ParseCoordinate(std::string_view name, std::string_view value)
+{
+    std::string result(value);
+    try
+    {
+        [[maybe_unused]] const Float coordinate = RealTraits<Float>::FromString(result);
+    }
+    catch (const std::exception&)
+    {
+        throw std::runtime_error(fmt::format("{} expects a decimal number, got \"{}\"", name, value));
+    }
+
+    return result;
+}
+
+HeadlessJob ParseJob(std::span<const std::string_view> arguments, const HeadlessJob& defaults)
+{
+    HeadlessJob job = defaults;
+    for (size_t index = 0; index != arguments.size(); index += 2)
+    {
+        const std::string_view name = arguments[index];
+        if (index + 1 == arguments.size())
+        {
+            throw std::runtime_error(fmt::format("{} expects a value", name));
+        }
+
+        const std::string_view value = arguments[index + 1];
+        if (name == "--center-x")
+        {
+            job.center_x = ParseCoordinate(name, value);
+        }
+        else if (name == "--center-y")
+        {
+            job.center_y = ParseCoordinate(name, value);
+        }
+        else if (name == "--zoom")
+        {
+            job.zoom = ParseInteger<uint16_t>(name, value, 0, std::numeric_limits<uint16_t>::max());
+        }
+        else if (name == "--width")
+        {
+            job.width = ParseInteger<size_t>(name, value, 1, 1 << 16);
+        }
+        else if (name == "--height")
+        {
+            job.height = ParseInteger<size_t>(name, value, 1, 1 << 16);
+        }
+        else if (name == "--iterations")
+        {
+            // The palette needs at least one iteration per color
+            job.max_iterations = ParseInteger<uint32_t>(
+                name,
+                value,
+                FractalSettings::colors_count,
+                FractalSettings::max_iterations_limit);
+        }
+        else if (name == "--precision")
+        {
+            job.precision = value == "auto" ? std::nullopt : std::optional(ParseName(name, value, kPrecisionNames));
+        }
+        else if (name == "--algorithm")
+        {
+            job.algorithm = ParseName(name, value, kAlgorithmNames);
+        }
+        else if (name == "--color-seed")
+        {
+            job.color_seed = ParseInteger<int>(name, value, 0, std::numeric_limits<int>::max());
+        }
+        else if (name == "--image")
+        {
+            job.image_path = value;
+            const std::filesystem::path extension = job.image_path.extension();
+            if (extension != ".ppm" && extension != ".png")
+            {
+                throw std::runtime_error(fmt::format("--image must end with .ppm or .png, got \"{}\"", value));
+            }
+        }
+        else if (name == "--iterations-dump")
+        {
+            job.iterations_path = value;
+        }
+        else
+        {
+            throw std::runtime_error(fmt::format("Unknown option {}", name));
+        }
+    }
+
+    return job;
+}
+
+std::vector<std::string_view> ParseOptions(std::span<const std::string_view> arguments, HeadlessOptions& options)
+{
+    std::vector<std::string_view> rest;
+    for (size_t index = 0; index != arguments.size(); ++index)
+    {
+        const std::string_view name = arguments[index];
+        if (name != "--threads" && name != "--jobs")
+        {
+            rest.push_back(name);
+            continue;
+        }
+
+        if (++index == arguments.size())
+        {
+            throw std::runtime_error(fmt::format("{} expects a value", name));
+        }
+
+        if (name == "--threads")
+        {
+            options.threads_count = ParseInteger<size_t>(name, arguments[index], 1, 1024);
+        }
+        else
+        {
+            options.jobs_path = arguments[index];
+        }
+    }
+
+    return rest;
+}
+
+std::vector<HeadlessJob> ReadJobFile(const std::filesystem::path& path, const HeadlessJob& defaults)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        throw std::runtime_error(fmt::format("Failed to open job file {}", path.string()));
+    }
+
+    std::vector<HeadlessJob> jobs;
+    std::string line;
+    std::vector<std::string_view> arguments;
+    for (size_t line_number = 1; std::getline(file, line); ++line_number)
+    {
+        arguments.clear();
+        const std::string_view text = line;
+        size_t position = text.find_first_not_of(" \t\r");
+        if (position == std::string_view::npos || text[position] == '#')
+        {
+            continue;
+        }
+
+        while (position != std::string_view::npos)
+        {
+            const size_t end = text.find_first_of(" \t\r", position);
+            arguments.push_back(text.substr(position, end - position));
+            position = text.find_first_not_of(" \t\r", end);
+        }
+
+        try
+        {
+            jobs.push_back(ParseJob(arguments, defaults));
+        }
+        catch (const std::exception& exception)
+        {
+            throw std::runtime_error(fmt::format("{}:{}: {}", path.string(), line_number, exception.what()));
+        }
+    }
+
+    return jobs;
+}
+
+FractalSettings MakeSettings(const HeadlessJob& job)
+{
+    FractalSettings settings;
+    settings.SetViewportSize(job.width, job.height);
+    settings.SetZoom(job.zoom);
+    if (settings.GetZoom() != job.zoom)
+    {
+        throw std::runtime_error(fmt::format(
+            "--zoom {} is deeper than coordinates resolve at {}x{}, at most {}",
+            job.zoom,
+            job.width,
+            job.height,
+            settings.GetMaxZoom()));
+    }
+
+    Vector2f camera;
+    camera.x() = RealTraits<Float>::FromString(job.center_x);
+    camera.y() = RealTraits<Float>::FromString(job.center_y);
+    settings.SetCamera(camera);
+    settings.max_iterations = job.max_iterations;
+    settings.auto_precision = !job.precision.has_value();
+    settings.precision = job.precision.value_or(settings.precision);
+    settings.render_algorithm = job.algorithm;
+    settings.color_seed = job.color_seed;
+    settings.RandomizeColors();
+    return settings;
+}
+
+std::string_view GetHeadlessUsage()
+{
+    return "Usage: fractal_headless [options]\n"
+           "  --center-x <decimal>         view center, 0 by default\n"
+           "  --center-y <decimal>\n"
+           "  --zoom <steps>               zoom steps of the app, 0 by default\n"
+           "  --width <pixels>             800 by default\n"
+           "  --height <pixels>\n"
+           "  --iterations <count>         max iterations, 1000 by default\n"
+           "  --precision <name>           auto, float, double, double-double, quad-double or multiprecision\n"
+           "  --algorithm <name>           brute-force, mariani-silver, boundary-tracing, solid-guessing\n"
+           "                               or interleaved\n"
+           "  --color-seed <seed>          palette seed, 1234 by default\n"
+           "  --image <path>               writes .ppm or .png\n"
+           "  --iterations-dump <path>     writes raw iteration counts\n"
+           "  --threads <count>            worker threads shared by all jobs, all cores by default\n"
+           "  --jobs <path>                one job per line with the options above, the command line\n"
+           "                               options are the defaults of every job\n";
+}
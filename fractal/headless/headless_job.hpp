@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "fractal_settings.hpp"
+#include "precision.hpp"
+#include "render_algorithm.hpp"
+
+// One image to render. The view matches the app: zoom is the number of zoom steps of the app
+// and the center is a decimal string so that deep zoom coordinates keep all their digits.
+struct HeadlessJob
+{
+    std::string center_x = "0";
+    std::string center_y = "0";
+    uint16_t zoom = 0;
+    size_t width = 800;
+    size_t height = 800;
+    uint32_t max_iterations = 1000;
+    // Chosen from the pixel size like the app does when not set
+    std::optional<FractalPrecision> precision;
+    FractalRenderAlgorithm algorithm = FractalRenderAlgorithm::BruteForce;
+    int color_seed = 1234;
+    // .ppm or .png
+    std::filesystem::path image_path;
+    // Raw iteration counts, see WriteIterations
+    std::filesystem::path iterations_path;
+};
+
+// Options shared by all jobs of one run
+struct HeadlessOptions
+{
+    size_t threads_count = 0;
+    std::filesystem::path jobs_path;
+};
+
+// Parses "--name value" pairs on top of the defaults. Throws on unknown options and bad values.
+HeadlessJob ParseJob(std::span<const std::string_view> arguments, const HeadlessJob& defaults);
+
+// Takes --threads and --jobs out of the arguments and returns the rest
+std::vector<std::string_view> ParseOptions(std::span<const std::string_view> arguments, HeadlessOptions& options);
+
+// One job per line with the same options as the command line, which are the defaults for every job.
+// Values are separated by whitespace and can not contain it. Empty lines and lines starting with # are skipped.
+std::vector<HeadlessJob> ReadJobFile(const std::filesystem::path& path, const HeadlessJob& defaults);
+
+// Settings with the view, algorithm and palette of the job for RenderFrame.
+// Throws if the zoom is deeper than Float coordinates resolve.
+FractalSettings MakeSettings(const HeadlessJob& job);
+
+std::string_view GetHeadlessUsage();
@@ -0,0 +1,207 @@
+#include "image_writer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "fmt/format.h"
+
+static std::ofstream OpenOutput(const std::filesystem::path& path)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+    {
+        throw std::runtime_error(fmt::format("Failed to open {} for writing", path.string()));
+    }
+
+    return file;
+}
+
+static void WriteBytes(std::ofstream& file, const std::filesystem::path& path, std::span<const uint8_t> bytes)
+{
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    if (!file)
+    {
+        throw std::runtime_error(fmt::format("Failed to write {}", path.string()));
+    }
+}
+
+static void AppendBigEndian(std::vector<uint8_t>& bytes, uint32_t value)
+{
+    for (int shift = 24; shift >= 0; shift -= 8)
+    {
+        bytes.push_back(static_cast<uint8_t>(value >> shift));
+    }
+}
+
+static void AppendLittleEndian(std::vector<uint8_t>& bytes, uint32_t value)
+{
+    for (int shift = 0; shift != 32; shift += 8)
+    {
+        bytes.push_back(static_cast<uint8_t>(value >> shift));
+    }
+}
+
+static uint32_t Crc32(std::span<const uint8_t> bytes)
+{
+    static const std::array<uint32_t, 256> table = []
+    {
+        std::array<uint32_t, 256> result{};
+        for (uint32_t index = 0; index != result.size(); ++index)
+        {
+            uint32_t value = index;
+            for (int bit = 0; bit != 8; ++bit)
+            {
+                value = (value & 1) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+            }
+            result[index] = value;
+        }
+        return result;
+    }();
+
+    uint32_t crc = 0xFFFFFFFFu;
+    for (const uint8_t byte : bytes)
+    {
+        crc = table[(crc ^ byte) & 0xFF] ^ (crc >> 8);
+    }
+
+    return crc ^ 0xFFFFFFFFu;
+}
+
+static uint32_t Adler32(std::span<const uint8_t> bytes)
+{
+    constexpr uint32_t kModulo = 65521;
+    // Largest run of bytes after which the sums still fit into uint32_t
+    constexpr size_t kMaxRun = 5552;
+    uint32_t a = 1;
+    uint32_t b = 0;
+    for (size_t offset = 0; offset < bytes.size(); offset += kMaxRun)
+    {
+        for (const uint8_t byte : bytes.subspan(offset, std::min(kMaxRun, bytes.size() - offset)))
+        {
+            a += byte;
+            b += a;
+        }
+
+        a %= kModulo;
+        b %= kModulo;
+    }
+
+    return (b << 16) | a;
+}
+
+static void WritePngChunk(
+    std::ofstream& file,
+    const std::filesystem::path& path,
+    std::string_view type,
+    std::span<const uint8_t> data)
+{
+    assert(type.size() == 4);
+    std::vector<uint8_t> chunk;
+    chunk.reserve(data.size() + 12);
+    AppendBigEndian(chunk, static_cast<uint32_t>(data.size()));
+    chunk.insert(chunk.end(), type.begin(), type.end());
+    chunk.insert(chunk.end(), data.begin(), data.end());
+
+    // CRC covers the type and the data
+    AppendBigEndian(chunk, Crc32(std::span{chunk}.subspan(4)));
+    WriteBytes(file, path, chunk);
+}
+
+void WritePpm(const std::filesystem::path& path, size_t width, size_t height, std::span<const uint32_t> rgba)
+{
+    assert(rgba.size() == width * height);
+    std::ofstream file = OpenOutput(path);
+    const std::string header = fmt::format("P6\n{} {}\n255\n", width, height);
+    WriteBytes(file, path, {reinterpret_cast<const uint8_t*>(header.data()), header.size()});
+
+    std::vector<uint8_t> pixels;
+    pixels.reserve(rgba.size() * 3);
+    for (const uint32_t color : rgba)
+    {
+        pixels.push_back(static_cast<uint8_t>(color));
+        pixels.push_back(static_cast<uint8_t>(color >> 8));
+        pixels.push_back(static_cast<uint8_t>(color >> 16));
+    }
+
+    WriteBytes(file, path, pixels);
+}
+
+void WritePng(const std::filesystem::path& path, size_t width, size_t height, std::span<const uint32_t> rgba)
+{
+    assert(rgba.size() == width * height);
+
+    // Every row starts with filter type 0 (none)
+    std::vector<uint8_t> scanlines;
+    scanlines.reserve(height * (width * 4 + 1));
+    for (size_t y = 0; y != height; ++y)
+    {
+        scanlines.push_back(0);
+        for (const uint32_t color : rgba.subspan(y * width, width))
+        {
+            AppendLittleEndian(scanlines, color);
+        }
+    }
+
+    // zlib stream of stored deflate blocks of at most 65535 bytes
+    constexpr size_t kMaxBlockSize = 65535;
+    std::vector<uint8_t> compressed{0x78, 0x01};
+    compressed.reserve(scanlines.size() + scanlines.size() / kMaxBlockSize * 5 + 16);
+    for (size_t offset = 0; offset == 0 || offset != scanlines.size();)
+    {
+        const size_t size = std::min(kMaxBlockSize, scanlines.size() - offset);
+        const bool last = offset + size == scanlines.size();
+        compressed.push_back(last ? 1 : 0);
+        compressed.push_back(static_cast<uint8_t>(size));
+        compressed.push_back(static_cast<uint8_t>(size >> 8));
+        compressed.push_back(static_cast<uint8_t>(~size));
+        compressed.push_back(static_cast<uint8_t>(~size >> 8));
+        compressed.insert(
+            compressed.end(),
+            scanlines.begin() + static_cast<ptrdiff_t>(offset),
+            scanlines.begin() + static_cast<ptrdiff_t>(offset + size));
+        offset += size;
+    }
+    AppendBigEndian(compressed, Adler32(scanlines));
+
+    // 8 bits per channel, color type 6 (RGBA), default compression, filter and no interlace
+    std::vector<uint8_t> header;
+    AppendBigEndian(header, static_cast<uint32_t>(width));
+    AppendBigEndian(header, static_cast<uint32_t>(height));
+    header.insert(header.end(), {8, 6, 0, 0, 0});
+
+    std::ofstream file = OpenOutput(path);
+    constexpr std::array<uint8_t, 8> kSignature{0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    WriteBytes(file, path, kSignature);
+    WritePngChunk(file, path, "IHDR", header);
+    WritePngChunk(file, path, "IDAT", compressed);
+    WritePngChunk(file, path, "IEND", {});
+}
+
+void WriteIterations(
+    const std::filesystem::path& path,
+    size_t width,
+    size_t height,
+    uint32_t max_iterations,
+    std::span<const uint32_t> iterations)
+{
+    assert(iterations.size() == width * height);
+    constexpr std::string_view kMagic = "FRACITER";
+    std::vector<uint8_t> bytes(kMagic.begin(), kMagic.end());
+    bytes.reserve(kMagic.size() + 12 + iterations.size() * sizeof(uint32_t));
+    AppendLittleEndian(bytes, static_cast<uint32_t>(width));
+    AppendLittleEndian(bytes, static_cast<uint32_t>(height));
+    AppendLittleEndian(bytes, max_iterations);
+    for (const uint32_t count : iterations)
+    {
+        AppendLittleEndian(bytes, count);
+    }
+
+    std::ofstream file = OpenOutput(path);
+    WriteBytes(file, path, bytes);
+}
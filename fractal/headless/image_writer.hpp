@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+// Writers of rendered images. Pixels are RGBA8 (R in the lowest byte) row by row from the top row.
+// All of them throw std::runtime_error if the file can not be written.
+
+// Binary PPM (P6), alpha is dropped
+void WritePpm(const std::filesystem::path& path, size_t width, size_t height, std::span<const uint32_t> rgba);
+
+// 8-bit RGBA PNG. The image data is not compressed (stored deflate blocks) so no zlib is needed.
+void WritePng(const std::filesystem::path& path, size_t width, size_t height, std::span<const uint32_t> rgba);
+
+// Raw iteration counts: "FRACITER", then width, height and max iterations as little endian uint32,
+// then width * height little endian uint32 counts row by row from the top row.
+// Counts equal to max iterations are pixels that did not escape.
+void WriteIterations(
+    const std::filesystem::path& path,
+    size_t width,
+    size_t height,
+    uint32_t max_iterations,
+    std::span<const uint32_t> iterations);
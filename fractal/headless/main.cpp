@@ -0,0 +1,78 @@
+#include <cstdio>
+#include <exception>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#include "cpu_worker_pool.hpp"
+#include "fmt/format.h"
+#include "frame_renderer.hpp"
+#include "headless_job.hpp"
+#include "image_writer.hpp"
+
+// Renders images with the CPU engine without a window or an OpenGL context
+int main(int argc, char** argv)
+{
+    try
+    {
+        const std::vector<std::string_view> arguments(argv + 1, argv + argc);
+        if (arguments.empty() || arguments.front() == "--help")
+        {
+            fmt::print("{}", GetHeadlessUsage());
+            return arguments.empty() ? 1 : 0;
+        }
+
+        HeadlessOptions options;
+        const std::vector<std::string_view> job_arguments = ParseOptions(arguments, options);
+        const HeadlessJob defaults = ParseJob(job_arguments, HeadlessJob{});
+        const std::vector<HeadlessJob> jobs =
+            options.jobs_path.empty() ? std::vector{defaults} : ReadJobFile(options.jobs_path, defaults);
+        for (size_t index = 0; index != jobs.size(); ++index)
+        {
+            if (jobs[index].image_path.empty() && jobs[index].iterations_path.empty())
+            {
+                throw std::runtime_error(fmt::format("Job {} has neither --image nor --iterations-dump", index + 1));
+            }
+        }
+
+        FractalCPUWorkerPool workers(
+            options.threads_count != 0 ? options.threads_count : FractalCPUWorkerPool::GetDefaultThreadsCount());
+        for (const HeadlessJob& job : jobs)
+        {
+            const RenderedFrame frame = RenderFrame(workers, MakeSettings(job));
+            if (!job.image_path.empty())
+            {
+                if (job.image_path.extension() == ".png")
+                {
+                    WritePng(job.image_path, job.width, job.height, frame.rgba);
+                }
+                else
+                {
+                    WritePpm(job.image_path, job.width, job.height, frame.rgba);
+                }
+            }
+
+            if (!job.iterations_path.empty())
+            {
+                WriteIterations(job.iterations_path, job.width, job.height, job.max_iterations, frame.iterations);
+            }
+
+            fmt::print(
+                "{}x{} {} in {:.3f} s, {} pixels iterated, {} filled: {}\n",
+                job.width,
+                job.height,
+                ToString(frame.precision),
+                frame.duration_seconds,
+                frame.stats.pixels_computed,
+                frame.stats.pixels_filled,
+                (job.image_path.empty() ? job.iterations_path : job.image_path).string());
+        }
+    }
+    catch (const std::exception& exception)
+    {
+        fmt::print(stderr, "{}\n", exception.what());
+        return 1;
+    }
+
+    return 0;
+}
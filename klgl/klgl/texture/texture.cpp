@@ -1,10 +1,39 @@
 #include "klgl/texture/texture.hpp"
 
 #include <cassert>
+#include <cstring>
+#include <vector>
 
 namespace klgl
 {
 
+namespace
+{
+
+struct TextureFormatInfo
+{
+    GLint internal_format;
+    GLenum pixel_data_format;
+    GLenum pixel_data_type;
+    size_t bytes_per_pixel;
+};
+
+TextureFormatInfo GetFormatInfo(TextureFormat format)
+{
+    switch (format)
+    {
+    case TextureFormat::R16UI:
+        return {GL_R16UI, GL_RED_INTEGER, GL_UNSIGNED_SHORT, 2};
+    case TextureFormat::R32UI:
+        return {GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, 4};
+    case TextureFormat::RGBA8:
+    default:
+        return {GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, 4};
+    }
+}
+
+}  // namespace
+
 std::unique_ptr<Texture> Texture::CreateEmpty(size_t width, size_t height, GLint internal_format)
 {
     assert(width != 0 && height != 0);
@@ -33,6 +62,49 @@ std::unique_ptr<Texture> Texture::CreateEmpty(size_t width, size_t height, GLint
     return tex;
 }
 
+std::unique_ptr<Texture> Texture::CreateStreaming(const Eigen::Vector2<size_t>& size, TextureFormat format)
+{
+    assert(size.x() != 0 && size.y() != 0);
+    auto tex = std::make_unique<Texture>();
+    tex->texture_ = OpenGl::GenTexture();
+    tex->type_ = GL_TEXTURE_2D;
+    tex->width_ = size.x();
+    tex->height_ = size.y();
+    tex->format_ = format;
+    tex->Bind();
+
+    const TextureFormatInfo info = GetFormatInfo(format);
+    if (GLAD_GL_VERSION_4_2)
+    {
+        glTexStorage2D(
+            tex->type_,
+            1,
+            static_cast<GLenum>(info.internal_format),
+            static_cast<GLsizei>(size.x()),
+            static_cast<GLsizei>(size.y()));
+    }
+    else
+    {
+        OpenGl::TexImage2d(
+            tex->type_,
+            0,
+            info.internal_format,
+            size.x(),
+            size.y(),
+            info.pixel_data_format,
+            info.pixel_data_type,
+            nullptr);
+        OpenGl::SetTextureParameter(tex->type_, GL_TEXTURE_MAX_LEVEL, 0);
+    }
+
+    OpenGl::SetTexture2dWrap(GlTextureWrap::S, GlTextureWrapMode::ClampToEdge);
+    OpenGl::SetTexture2dWrap(GlTextureWrap::T, GlTextureWrapMode::ClampToEdge);
+    OpenGl::SetTexture2dMagFilter(GlTextureFilter::Nearest);
+    OpenGl::SetTexture2dMinFilter(GlTextureFilter::Nearest);
+
+    return tex;
+}
+
 void Texture::Bind() const
 {
     OpenGl::BindTexture(type_, *texture_);
@@ -58,6 +130,7 @@ void Texture::SetPixels(std::span<const Eigen::Vector3<uint8_t>> pixel_data)
         pixel_data.data());
     assert(glGetError() == GL_NO_ERROR);
 
+#ifdef KLGL_VERIFY_TEXTURE_UPLOADS
     std::vector<Eigen::Vector3<uint8_t>> got_pixels;
     got_pixels.resize(pixel_data.size());
     glGetTexImage(GL_TEXTURE_2D, 0, pixel_data_format, pixel_data_type, got_pixels.data());
@@ -73,10 +146,86 @@ void Texture::SetPixels(std::span<const Eigen::Vector3<uint8_t>> pixel_data)
         }
     }
     assert(different_idnices.empty());
+#endif
+}
+
+void Texture::UploadRegionBytes(
+    const Eigen::Vector2<size_t>& offset,
+    const Eigen::Vector2<size_t>& size,
+    std::span<const std::byte> bytes)
+{
+    assert(format_.has_value());
+    assert(offset.x() + size.x() <= width_ && offset.y() + size.y() <= height_);
+    const TextureFormatInfo info = GetFormatInfo(*format_);
+    assert(bytes.size() == size.prod() * info.bytes_per_pixel);
+
+    UploadBuffer& upload = upload_ring_[next_upload_buffer_];
+    next_upload_buffer_ = (next_upload_buffer_ + 1) % upload_ring_.size();
+
+    if (upload.buffer == 0)
+    {
+        upload.buffer = OpenGl::GenBuffer();
+    }
+
+    // Previous transfer from this buffer may still be in flight
+    if (upload.fence)
+    {
+        constexpr GLuint64 kTimeoutNanoseconds = 100'000'000;
+        GLenum wait_result = GL_TIMEOUT_EXPIRED;
+        while (wait_result == GL_TIMEOUT_EXPIRED)
+        {
+            wait_result = glClientWaitSync(upload.fence, GL_SYNC_FLUSH_COMMANDS_BIT, kTimeoutNanoseconds);
+        }
+
+        glDeleteSync(upload.fence);
+        upload.fence = nullptr;
+    }
+
+    OpenGl::BindBuffer(GL_PIXEL_UNPACK_BUFFER, upload.buffer);
+    if (upload.capacity < bytes.size())
+    {
+        upload.capacity = bytes.size();
+        OpenGl::BufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(upload.capacity), nullptr, GL_STREAM_DRAW);
+    }
+
+    // The fence above already guarantees that the GPU does not read this buffer
+    constexpr GLbitfield kMapFlags = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+    void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(bytes.size()), kMapFlags);
+    assert(mapped);
+    std::memcpy(mapped, bytes.data(), bytes.size());
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+    Bind();
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(
+        type_,
+        0,
+        static_cast<GLint>(offset.x()),
+        static_cast<GLint>(offset.y()),
+        static_cast<GLsizei>(size.x()),
+        static_cast<GLsizei>(size.y()),
+        info.pixel_data_format,
+        info.pixel_data_type,
+        nullptr);
+    upload.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    OpenGl::BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
 }
 
 Texture::~Texture()
 {
+    for (UploadBuffer& upload : upload_ring_)
+    {
+        if (upload.fence)
+        {
+            glDeleteSync(upload.fence);
+        }
+
+        if (upload.buffer != 0)
+        {
+            glDeleteBuffers(1, &upload.buffer);
+        }
+    }
+
     if (texture_)
     {
         glDeleteTextures(1, &*texture_);
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
 #include <memory>
 #include <optional>
 #include <span>
@@ -10,15 +12,42 @@
 namespace klgl
 {
 
+// Formats of streaming textures. Integer formats must be sampled with usampler2D.
+enum class TextureFormat : uint8_t
+{
+    RGBA8,
+    R16UI,
+    R32UI
+};
+
 class Texture
 {
 public:
     static std::unique_ptr<Texture> CreateEmpty(size_t width, size_t height, GLint internal_format = GL_RGB);
 
+    // Texture with immutable storage (when GL 4.2 is available) that is updated by UploadRegion
+    static std::unique_ptr<Texture> CreateStreaming(const Eigen::Vector2<size_t>& size, TextureFormat format);
+
     ~Texture();
 
     void Bind() const;
+
+    // Synchronous upload of the whole texture. Build with KLGL_VERIFY_TEXTURE_UPLOADS to read the pixels back
+    // and compare them with the source.
     void SetPixels(std::span<const Eigen::Vector3<uint8_t>> pixel_data);
+
+    // Copies pixels to the next pixel unpack buffer of a ring and transfers them to the region of a streaming
+    // texture. Returns without waiting for the GPU; waits only when the ring wraps onto a buffer in flight.
+    // Pixel type must match the format: uint32_t for RGBA8 and R32UI, uint16_t for R16UI.
+    template <typename Pixel>
+    void UploadRegion(
+        const Eigen::Vector2<size_t>& offset,
+        const Eigen::Vector2<size_t>& size,
+        std::span<const Pixel> pixels)
+    {
+        UploadRegionBytes(offset, size, std::as_bytes(pixels));
+    }
+
     Eigen::Vector2<size_t> GetSize() const
     {
         return {width_, height_};
@@ -36,11 +65,29 @@ public:
         return texture_;
     }
 
+private:
+    struct UploadBuffer
+    {
+        GLuint buffer = 0;
+        size_t capacity = 0;
+        GLsync fence = nullptr;
+    };
+
+    static constexpr size_t kUploadRingSize = 8;
+
+    void UploadRegionBytes(
+        const Eigen::Vector2<size_t>& offset,
+        const Eigen::Vector2<size_t>& size,
+        std::span<const std::byte> bytes);
+
 private:
     std::optional<GLuint> texture_;
     size_t width_;
     size_t height_;
     GLenum type_ = GL_TEXTURE_2D;
+    std::optional<TextureFormat> format_;
+    std::array<UploadBuffer, kUploadRingSize> upload_ring_{};
+    size_t next_upload_buffer_ = 0;
 };
 
 }  // namespace klgl